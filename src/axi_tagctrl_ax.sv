@@ -5,7 +5,31 @@
 // Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
 // Date:   28.11.2023
 
-/// [TODO] Place description here.
+/// AX channel unit of the tag controller.
+///
+/// Forwards the AX beat to memory and generates the descriptors of the burst for the
+/// (module.axi_tagctrl_r) or (module.axi_tagctrl_w) unit and for the tag cache. A burst whose tag
+/// words lie in several tag cache lines is split into one tag cache descriptor per line. They are
+/// issued back-to-back, the last one of the burst has `x_last` set.
+///
+/// An AR burst inside a single tag word of the tag word buffer, see (module.axi_tagctrl_tag_buf),
+/// gets the tag word in its descriptor and makes no tag cache descriptor.
+///
+/// ## Atomic transactions
+///
+/// Atomics (ATOPs) of the AW channel are forwarded to memory with an ID of their own, the ID bit
+/// `AxiIdWidth-1` is flipped. Their R beats are told apart from the ones of the AR channel with it.
+/// An atomic which returns data first reads the tag word of the capability, with the same ID bit
+/// flipped in the tag cache descriptor, its tag cache write follows right behind.
+/// The tag cache write of an AtomicCompare is held until `atop_release_i`, the
+/// (module.axi_tagctrl_w) unit only knows the new tag once memory returned the old data. It is
+/// parked in a register of its own, the AX register takes the next burst in the meantime. The
+/// tag cache descriptor of that burst waits behind the parked one, the tag words of the W unit
+/// arrive in this order.
+///
+/// From the tag read until the tag write is issued `atop_lock_o` is set, `atop_lock_addr_o` holds
+/// the tag word of the atomic. (module.axi_tagctrl_top) holds the tag cache writes of the other
+/// slave ports to its tag cache line meanwhile, see `proc_atop_lock`.
 module axi_tagctrl_ax #(
     /// Tag Controller configuration struct. Passed down from `axi_tagctrl_top.sv`.
     parameter axi_tagctrl_pkg::tagctrl_cfg_t Cfg = axi_tagctrl_pkg::tagctrl_cfg_t'{default: '0},
@@ -13,6 +37,10 @@ module axi_tagctrl_ax #(
     /// `0`: AR channel is connected, descriptors do read accesses.
     /// `1`: AW channel is connected, descriptors do write accesses.
     parameter bit Write = 1'b0,
+    /// Index of the slave port of this unit, see `NumSlvPorts` of (module.axi_tagctrl_top).
+    /// The tag cache descriptors of the port carry the ID `AxReqId ^ PortIdx`, which routes the
+    /// tag cache responses back to it.
+    parameter int unsigned PortIdx = 32'd0,
     /// AXI Tag Controller descriptor type definition,
     parameter type tagctrl_desc_t = logic,
     /// AXI Tag Cache descriptor type definition,
@@ -30,6 +58,27 @@ module axi_tagctrl_ax #(
     input logic ax_chan_valid_i,
     /// AXI AX slave channel is ready.
     output logic ax_chan_ready_o,
+    /// The AX beat targets an untagged address region, see `axi_tagctrl_config`.
+    /// Untagged bursts do not generate a tag cache descriptor.
+    input logic untagged_i,
+    /// Tag cache way partition of the AX beat, see `axi_tagctrl_config`.
+    input axi_tagctrl_pkg::part_idx_t part_i,
+    /// The AX beat lies inside a tag word of the tag word buffer, only used on the AR channel.
+    input logic tagbuf_hit_i,
+    /// Buffered tag word of the AX beat.
+    input logic [Cfg.AxiDataWidth-1:0] tagbuf_data_i,
+    /// The tag word of the AX beat is filled into the tag word buffer once it arrives.
+    input logic tagbuf_fill_i,
+    /// First tag word of the AX beat, relative to `DRAMMemBase`.
+    output logic [Cfg.AxiAddrWidth-1:0] tag_word_first_o,
+    /// Last tag word of the AX beat, relative to `DRAMMemBase`.
+    output logic [Cfg.AxiAddrWidth-1:0] tag_word_last_o,
+    /// The held tag cache write of an AtomicCompare is released, only used on the AW channel.
+    input logic atop_release_i,
+    /// An atomic read its old tag word, its tag cache write is not issued yet.
+    output logic atop_lock_o,
+    /// Tag cache address of the tag word of the locking atomic.
+    output logic [Cfg.AxiAddrWidth-1:0] atop_lock_addr_o,
     /// Output Tag cache descriptor payload.
     output tagc_desc_t tagc_desc_o,
     /// Output Tag cache descripor is valid.
@@ -51,9 +100,12 @@ module axi_tagctrl_ax #(
 );
   `include "common_cells/registers.svh"
   // local typedefs
-  // master port ID is one bit wider than the slave port one, see `axi_mux`
-  typedef logic [Cfg.AxiIdWidth:0] id_mst_t;
+  // ID of the memory requests and tag cache descriptors, the memory side `axi_mux` of
+  // (module.axi_tagctrl_top) widens it by `MstIdExtWidth`
+  typedef logic [Cfg.AxiIdWidth-1:0] id_t;
   typedef logic [Cfg.AxiAddrWidth-1:0] addr_t;
+  // ID bit which marks the memory requests and tag cache reads of atomics
+  localparam id_t AtopIdBit = id_t'(1) << (Cfg.AxiIdWidth - 1);
 
   // Register to hold the descriptor for tag controller pipeline
   tagctrl_desc_t tagctrl_desc_d, tagctrl_desc_q;
@@ -70,41 +122,84 @@ module axi_tagctrl_ax #(
   logic slv_chan_valid_d, slv_chan_valid_q;
   logic load_slv_chan, load_slv_chan_valid;
 
+  // Tag words of the burst which still need a tag cache descriptor
+  addr_t tag_word_d, tag_word_q, tag_word_last_d, tag_word_last_q;
+  logic load_tag_word;
+
+  // The tag cache descriptor reads the old tag word of an atomic, the write follows
+  logic atop_wr_d, atop_wr_q;
+  // The atomic is an AtomicCompare, its tag cache write is parked once the read is sent
+  logic atop_cas_d, atop_cas_q;
+  logic load_atop;
+  // Parked tag cache write of an AtomicCompare, held until `atop_release_i`
+  tagc_desc_t atop_park_d, atop_park_q;
+  logic atop_park_valid_d, atop_park_valid_q;
+  logic load_atop_park, load_atop_park_valid;
+  logic atop_hold_d, atop_hold_q;
+  // The tag cache line of the atomic is locked, see `atop_lock_o`
+  logic atop_lock_d, atop_lock_q;
+  addr_t atop_lock_addr_d, atop_lock_addr_q;
+  logic load_atop_lock;
+
   // Auxiliary signals
   // Used to compute the end addr (addr begin + len)
   addr_t addr_end;
-  // Tag address offset to fetch
-  addr_t tag_addr, tag_hi_addr, tag_off;
-  // Used to compute the number of beats needed for the Tage Cache request
+  // Index of the first and last tag word of the burst, relative to `TagCacheMemBase`
+  addr_t tag_word_begin, tag_word_end;
+  // Number of tag words of the burst minus one
   axi_pkg::len_t tagc_desc_len;
-  logic [$clog2(Cfg.tagc_cfg.BlockSize / 8)-1:0] tagc_blk_ind_begin, tagc_blk_ind_end;
+  // Atomic operation of the AX beat, the AR channel has none
+  axi_pkg::atop_t atop;
+
+  if (Write) begin : gen_atop
+    assign atop = ax_chan_slv_i.atop;
+  end else begin : gen_no_atop
+    assign atop = '0;
+  end
+
+  // Tag cache descriptor for the tag words from `word` up to `last_word`, at most until the end of
+  // the tag cache line holding `word`.
+  function automatic tagc_desc_t line_desc(tagc_desc_t desc, addr_t word, addr_t last_word);
+    addr_t line_last;
+    line_last = word | addr_t'(Cfg.tagc_cfg.NumBlocks - 1);
+    if (last_word < line_last) begin
+      line_last = last_word;
+    end
+    desc.a_x_addr = addr_t'(Cfg.TagCacheMemBase) + (word << $clog2(Cfg.tagc_cfg.BlockSize / 8));
+    desc.a_x_len  = axi_pkg::len_t'(line_last - word);
+    desc.x_last   = (line_last == last_word);
+    return desc;
+  endfunction
 
   // output assignments
   assign tagctrl_desc_o = tagctrl_desc_q;
   assign tagctrl_valid_o = tagctrl_desc_valid_q;
-  assign tagc_desc_o = tagc_desc_q;
-  assign tagc_valid_o = tagc_desc_valid_q;
+  // a parked tag cache write goes before the descriptor of the next burst
+  assign tagc_desc_o = atop_park_valid_q ? atop_park_q : tagc_desc_q;
+  assign tagc_valid_o = atop_park_valid_q ? !atop_hold_q : tagc_desc_valid_q;
+  assign atop_lock_o = atop_lock_q;
+  assign atop_lock_addr_o = atop_lock_addr_q;
   assign ax_mem_chan_mst_o = slv_chan_q;
   assign ax_mem_chan_valid_o = slv_chan_valid_q;
   assign ax_chan_ready_o = ~slv_chan_valid_q && ~tagc_desc_valid_q && ~tagctrl_desc_valid_q;
-  assign addr_end = ax_chan_slv_i.addr + (ax_chan_slv_i.len << $clog2(Cfg.tagc_cfg.BlockSize / 8));
-  assign tagc_blk_ind_begin = ax_chan_slv_i.addr[($clog2(
-      Cfg.tagc_cfg.BlockSize*(Cfg.CapSize/8)
-  ))+:$clog2(
-      Cfg.tagc_cfg.BlockSize/8
-  )];
-  assign tagc_blk_ind_end = addr_end[($clog2(
-      Cfg.tagc_cfg.BlockSize*(Cfg.CapSize/8)
-  ))+:$clog2(
-      Cfg.tagc_cfg.BlockSize/8
-  )];
-  assign tagc_desc_len = $unsigned(tagc_blk_ind_end - tagc_blk_ind_begin);
-  assign tag_off = $unsigned(
+  // Only INCR bursts can span several tag words. A WRAP burst stays inside its naturally aligned
+  // wrap region (at most 16 beats), which always lies in the tag word of the start address.
+  // A FIXED burst accesses a single address.
+  assign addr_end = (ax_chan_slv_i.burst == axi_pkg::BURST_INCR) ?
+      ax_chan_slv_i.addr + (ax_chan_slv_i.len << ax_chan_slv_i.size) : ax_chan_slv_i.addr;
+  assign tag_word_begin = $unsigned(
       ax_chan_slv_i.addr - Cfg.DRAMMemBase
   ) >> $clog2(
       Cfg.tagc_cfg.BlockSize * (Cfg.CapSize / 8)
   );
-  assign tag_addr = Cfg.TagCacheMemBase + (tag_off << $clog2(Cfg.tagc_cfg.BlockSize / 8));
+  assign tag_word_end = $unsigned(
+      addr_end - Cfg.DRAMMemBase
+  ) >> $clog2(
+      Cfg.tagc_cfg.BlockSize * (Cfg.CapSize / 8)
+  );
+  assign tagc_desc_len = axi_pkg::len_t'(tag_word_end - tag_word_begin);
+  assign tag_word_first_o = tag_word_begin;
+  assign tag_word_last_o = tag_word_end;
 
   always_comb begin : ax_mem_chan_ctrl
     // default assignments
@@ -123,7 +218,14 @@ module axi_tagctrl_ax #(
       // handshake complete read the ax channel data if valid
       if (ax_chan_valid_i && ax_chan_ready_o) begin
         slv_chan_d = ax_chan_slv_i;
-        slv_chan_d.id = id_mst_t'(axi_tagctrl_pkg::AxReqId);
+        slv_chan_d.id = id_t'(axi_tagctrl_pkg::AxReqId);
+        if (atop[5:4] != axi_pkg::ATOP_NONE) begin
+          slv_chan_d.id = id_t'(axi_tagctrl_pkg::AxReqId) ^ AtopIdBit;
+        end
+        // untagged regions never carry capabilities
+        if (untagged_i) begin
+          slv_chan_d.user = '0;
+        end
         load_slv_chan = 1'b1;
         slv_chan_valid_d = 1'b1;
         load_slv_chan_valid = 1'b1;
@@ -137,35 +239,108 @@ module axi_tagctrl_ax #(
     load_tagc_desc = 1'b0;
     tagc_desc_valid_d = tagc_desc_valid_q;
     load_tagc_desc_valid = 1'b0;
+    tag_word_d = tag_word_q;
+    tag_word_last_d = tag_word_last_q;
+    load_tag_word = 1'b0;
+    atop_wr_d = atop_wr_q;
+    atop_cas_d = atop_cas_q;
+    load_atop = 1'b0;
+    atop_park_d = atop_park_q;
+    load_atop_park = 1'b0;
+    atop_park_valid_d = atop_park_valid_q;
+    load_atop_park_valid = 1'b0;
+    atop_hold_d = atop_hold_q && !atop_release_i;
+    atop_lock_d = atop_lock_q;
+    atop_lock_addr_d = atop_lock_addr_q;
+    load_atop_lock = 1'b0;
+
+    if (atop_park_valid_q) begin
+      // the parked tag cache write is sent, it unlocks the tag cache line
+      if (tagc_valid_o && tagc_ready_i) begin
+        atop_park_valid_d = 1'b0;
+        load_atop_park_valid = 1'b1;
+        atop_lock_d = 1'b0;
+        load_atop_lock = 1'b1;
+      end
+    end
 
     if (tagc_desc_valid_q) begin
-      // send new request transaction
-      if (tagc_ready_i) begin
-        tagc_desc_valid_d = 1'b0;
-        load_tagc_desc_valid = 1'b1;
+      // send new request transaction, after a parked tag cache write
+      if (tagc_valid_o && tagc_ready_i && !atop_park_valid_q) begin
+        if (atop_wr_q) begin
+          // the old tag word of the atomic is requested, now write the new one
+          tagc_desc_d = tagc_desc_q;
+          tagc_desc_d.a_x_id = id_t'(tagc_desc_q.a_x_id) ^ AtopIdBit;
+          tagc_desc_d.rw = 1'b1;
+          atop_wr_d = 1'b0;
+          load_atop = 1'b1;
+          atop_lock_d = 1'b1;
+          atop_lock_addr_d = tagc_desc_q.a_x_addr;
+          load_atop_lock = 1'b1;
+          if (atop_cas_q) begin
+            // park the write of an AtomicCompare, the AX register is free for the next burst
+            atop_park_d = tagc_desc_d;
+            load_atop_park = 1'b1;
+            atop_park_valid_d = 1'b1;
+            load_atop_park_valid = 1'b1;
+            atop_hold_d = 1'b1;
+            tagc_desc_valid_d = 1'b0;
+            load_tagc_desc_valid = 1'b1;
+          end else begin
+            load_tagc_desc = 1'b1;
+          end
+        end else if (atop_lock_q) begin
+          // the tag cache write of the atomic is sent, it unlocks the tag cache line
+          tagc_desc_valid_d = 1'b0;
+          load_tagc_desc_valid = 1'b1;
+          atop_lock_d = 1'b0;
+          load_atop_lock = 1'b1;
+        end else if (tagc_desc_q.x_last) begin
+          tagc_desc_valid_d = 1'b0;
+          load_tagc_desc_valid = 1'b1;
+        end else begin
+          // the burst continues in the next tag cache line, stay valid
+          tagc_desc_d = line_desc(tagc_desc_q, tag_word_q, tag_word_last_q);
+          load_tagc_desc = 1'b1;
+          tag_word_d = (tag_word_q | addr_t'(Cfg.tagc_cfg.NumBlocks - 1)) + addr_t'(1);
+          load_tag_word = 1'b1;
+        end
       end
     end else begin
-      // handshake complete read the ax channel data if valid
-      if (ax_chan_valid_i && ax_chan_ready_o) begin
+      // handshake complete read the ax channel data if valid, untagged bursts bypass the tag cache
+      // and bursts with a buffered tag word do not need it
+      if (ax_chan_valid_i && ax_chan_ready_o && !untagged_i && !tagbuf_hit_i) begin
         tagc_desc_d = tagc_desc_t'{
-            // assign the id value so that transactions are always order
+            // assign the id value so that transactions of a port are always in order
             a_x_id:
-            id_mst_t
+            id_t
             '(
             axi_tagctrl_pkg::AxReqId
-            ),
-            a_x_addr: tag_addr,
-            a_x_len: tagc_desc_len,
+            ) ^ id_t'(PortIdx),
             a_x_size: ax_chan_slv_i.size,
-            a_x_burst: ax_chan_slv_i.burst,
+            // tag words are always fetched linearly, whatever the burst type of the access
+            a_x_burst: axi_pkg::BURST_INCR,
             a_x_lock: ax_chan_slv_i.lock,
             a_x_prot: ax_chan_slv_i.prot,
             a_x_cache: ax_chan_slv_i.cache,
             x_resp: axi_pkg::RESP_OKAY,
             x_last: 1'b1,
             rw: Write,
+            part: part_i,
             default: '0
         };
+        tagc_desc_d = line_desc(tagc_desc_d, tag_word_begin, tag_word_end);
+        // atomics which return data first read the old tag word, it is returned with the data
+        if (atop[axi_pkg::ATOP_R_RESP]) begin
+          tagc_desc_d.a_x_id = id_t'(tagc_desc_d.a_x_id) ^ AtopIdBit;
+          tagc_desc_d.rw = 1'b0;
+        end
+        atop_wr_d = atop[axi_pkg::ATOP_R_RESP];
+        atop_cas_d = (atop == axi_pkg::ATOP_ATOMICCMP);
+        load_atop = 1'b1;
+        tag_word_d = (tag_word_begin | addr_t'(Cfg.tagc_cfg.NumBlocks - 1)) + addr_t'(1);
+        tag_word_last_d = tag_word_end;
+        load_tag_word = 1'b1;
         load_tagc_desc = 1'b1;
         tagc_desc_valid_d = 1'b1;
         load_tagc_desc_valid = 1'b1;
@@ -196,7 +371,13 @@ module axi_tagctrl_ax #(
             a_x_addr: ax_chan_slv_i.addr,
             a_x_len: ax_chan_slv_i.len,
             a_x_size: ax_chan_slv_i.size,
+            a_x_burst: ax_chan_slv_i.burst,
             a_x_tag_len: tagc_desc_len,
+            untagged: untagged_i,
+            tag_hit: !untagged_i && tagbuf_hit_i,
+            tag_fill: !untagged_i && tagbuf_fill_i,
+            tag_data: tagbuf_data_i,
+            atop: atop,
             default: '0
         };
         load_tagctrl_desc = 1'b1;
@@ -211,6 +392,15 @@ module axi_tagctrl_ax #(
   `FFLARN(slv_chan_valid_q, slv_chan_valid_d, load_slv_chan_valid, 1'b0, clk_i, rst_ni)
   `FFLARN(tagc_desc_q, tagc_desc_d, load_tagc_desc, tagc_desc_t'{default: '0}, clk_i, rst_ni)
   `FFLARN(tagc_desc_valid_q, tagc_desc_valid_d, load_tagc_desc_valid, 1'b0, clk_i, rst_ni)
+  `FFLARN(tag_word_q, tag_word_d, load_tag_word, '0, clk_i, rst_ni)
+  `FFLARN(tag_word_last_q, tag_word_last_d, load_tag_word, '0, clk_i, rst_ni)
+  `FFLARN(atop_wr_q, atop_wr_d, load_atop, 1'b0, clk_i, rst_ni)
+  `FFLARN(atop_cas_q, atop_cas_d, load_atop, 1'b0, clk_i, rst_ni)
+  `FFLARN(atop_park_q, atop_park_d, load_atop_park, tagc_desc_t'{default: '0}, clk_i, rst_ni)
+  `FFLARN(atop_park_valid_q, atop_park_valid_d, load_atop_park_valid, 1'b0, clk_i, rst_ni)
+  `FF(atop_hold_q, atop_hold_d, 1'b0, clk_i, rst_ni)
+  `FFLARN(atop_lock_q, atop_lock_d, load_atop_lock, 1'b0, clk_i, rst_ni)
+  `FFLARN(atop_lock_addr_q, atop_lock_addr_d, load_atop_lock, '0, clk_i, rst_ni)
   `FFLARN(tagctrl_desc_q, tagctrl_desc_d, load_tagctrl_desc, tagctrl_desc_t'{default: '0}, clk_i,
           rst_ni)
   `FFLARN(tagctrl_desc_valid_q, tagctrl_desc_valid_d, load_tagctrl_desc_valid, 1'b0, clk_i, rst_ni)
@@ -175,6 +175,9 @@ module axi_tagctrl_config #(
     parameter axi_llc_pkg::llc_axi_cfg_t AxiCfg = axi_llc_pkg::llc_axi_cfg_t'{default: '0},
     /// Register Width
     parameter int unsigned RegWidth = 64,
+    /// Number of AXI slave ports, see (module.axi_tagctrl_top). The address region and way
+    /// partition decoding is done for the AX beats of every port.
+    parameter int unsigned NumSlvPorts = 32'd1,
     /// Register type for HW -> Register direction
     parameter type conf_regs_d_t = logic,
     /// Register type for Register -> HW direction
@@ -238,6 +241,10 @@ module axi_tagctrl_config #(
     /// This signal is needed for the flush control so that no active functional descriptors
     /// interfere with the flush operation.
     input logic ar_unit_busy_i,
+    /// The background flush unit has descriptors in flight.
+    ///
+    /// Its flush descriptors also signal `flush_desc_recv_i`, the flush starts after they are done.
+    input logic flush_unit_busy_i,
     /// A flush descriptor is finished flushing its cache line.
     ///
     /// This is for controlling the counters which keep track of how many flush descriptors are
@@ -256,7 +263,34 @@ module axi_tagctrl_config #(
     /// Address rule for the AXI memory region which maps to the scratch pad memory region.
     ///
     /// Accesses are only successful, if the corresponding way is mapped as SPM
-    input rule_full_t axi_spm_rule_i
+    input rule_full_t axi_spm_rule_i,
+    /// Programmable address regions from the tag controller register file.
+    ///
+    /// Addresses outside of every enabled region are tagged. Where enabled regions overlap,
+    /// the region with the highest index decides.
+    input axi_tagctrl_pkg::addr_region_t [axi_tagctrl_pkg::NumAddrRegions-1:0] addr_regions_i,
+    /// Address of the AW beat on each AXI slave port.
+    input addr_full_t [NumSlvPorts-1:0] slv_aw_addr_i,
+    /// Address of the AR beat on each AXI slave port.
+    input addr_full_t [NumSlvPorts-1:0] slv_ar_addr_i,
+    /// The AW beat targets an untagged region and bypasses the tag cache.
+    output logic [NumSlvPorts-1:0] aw_untagged_o,
+    /// The AR beat targets an untagged region and bypasses the tag cache.
+    output logic [NumSlvPorts-1:0] ar_untagged_o,
+    /// Tag cache way partitions from the tag controller register file.
+    input axi_tagctrl_pkg::partition_t [axi_tagctrl_pkg::NumPartitions-1:0] partitions_i,
+    /// AXI ID of the AW beat on each AXI slave port.
+    input logic [NumSlvPorts-1:0][AxiCfg.SlvPortIdWidth-1:0] slv_aw_id_i,
+    /// AXI user bits of the AW beat on each AXI slave port, zero extended.
+    input logic [NumSlvPorts-1:0][31:0] slv_aw_user_i,
+    /// AXI ID of the AR beat on each AXI slave port.
+    input logic [NumSlvPorts-1:0][AxiCfg.SlvPortIdWidth-1:0] slv_ar_id_i,
+    /// AXI user bits of the AR beat on each AXI slave port, zero extended.
+    input logic [NumSlvPorts-1:0][31:0] slv_ar_user_i,
+    /// Tag cache way partition of the AW beat on each AXI slave port.
+    output axi_tagctrl_pkg::part_idx_t [NumSlvPorts-1:0] aw_part_o,
+    /// Tag cache way partition of the AR beat on each AXI slave port.
+    output axi_tagctrl_pkg::part_idx_t [NumSlvPorts-1:0] ar_part_o
 );
   // register macros from `common_cells`
   `include "common_cells/registers.svh"
@@ -292,6 +326,55 @@ module axi_tagctrl_config #(
     axi_addr_map[1].idx[0] = &conf_regs_i.flushed;
   end
 
+  //////////////////////////////
+  // Untagged region decoding //
+  //////////////////////////////
+  // The region bounds are aligned to `axi_tagctrl_pkg::AddrRegionAlign`, a burst never leaves
+  // the region of its start address.
+  always_comb begin : proc_untagged_decode
+    aw_untagged_o = '0;
+    ar_untagged_o = '0;
+    for (int unsigned p = 0; p < NumSlvPorts; p++) begin
+      for (int unsigned i = 0; i < axi_tagctrl_pkg::NumAddrRegions; i++) begin
+        if (addr_regions_i[i].en) begin
+          if ((slv_aw_addr_i[p] >= addr_regions_i[i].start_addr) &&
+              (slv_aw_addr_i[p] < addr_regions_i[i].end_addr)) begin
+            aw_untagged_o[p] = addr_regions_i[i].untagged;
+          end
+          if ((slv_ar_addr_i[p] >= addr_regions_i[i].start_addr) &&
+              (slv_ar_addr_i[p] < addr_regions_i[i].end_addr)) begin
+            ar_untagged_o[p] = addr_regions_i[i].untagged;
+          end
+        end
+      end
+    end
+  end
+
+  ////////////////////////////
+  // Way partition decoding //
+  ////////////////////////////
+  // Partition 0 is the default partition, the enabled partition with the highest index wins.
+  always_comb begin : proc_partition_decode
+    aw_part_o = '0;
+    ar_part_o = '0;
+    for (int unsigned p = 0; p < NumSlvPorts; p++) begin
+      for (int unsigned i = 1; i < axi_tagctrl_pkg::NumPartitions; i++) begin
+        if (partitions_i[i].en) begin
+          if ((32'(slv_aw_id_i[p]) >= partitions_i[i].id_first) &&
+              (32'(slv_aw_id_i[p]) <= partitions_i[i].id_last) &&
+              ((slv_aw_user_i[p] & partitions_i[i].user_mask) == partitions_i[i].user_value)) begin
+            aw_part_o[p] = axi_tagctrl_pkg::part_idx_t'(i);
+          end
+          if ((32'(slv_ar_id_i[p]) >= partitions_i[i].id_first) &&
+              (32'(slv_ar_id_i[p]) <= partitions_i[i].id_last) &&
+              ((slv_ar_user_i[p] & partitions_i[i].user_mask) == partitions_i[i].user_value)) begin
+            ar_part_o[p] = axi_tagctrl_pkg::part_idx_t'(i);
+          end
+        end
+      end
+    end
+  end
+
   //////////////////////////////////////////////////////////////////
   // Configuration registers: Flush Control, Performance Counters //
   //////////////////////////////////////////////////////////////////
@@ -384,8 +467,8 @@ module axi_tagctrl_config #(
         end
       end
       FsmWaitSplitter: begin
-        // wait till none of the splitter units still have vectors in them
-        if (!aw_unit_busy_i && !ar_unit_busy_i) begin
+        // wait till none of the splitter units or the flush unit still have vectors in them
+        if (!aw_unit_busy_i && !ar_unit_busy_i && !flush_unit_busy_i) begin
           flush_state_d = FsmInitFlush;
         end
       end
@@ -0,0 +1,222 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+`include "common_cells/registers.svh"
+
+/// Eviction box of the tag cache, selects the way a missing tag line gets stored in.
+///
+/// Invalid ways are always filled first. When all ways of the cache line are valid, the victim
+/// is chosen by the replacement policy `ReplPolicy`:
+/// * `ReplRandom`: pseudo random way from an LFSR.
+/// * `ReplPlru`:   tree pseudo least recently used. Requires a power of two set-associativity.
+/// * `ReplSrrip`:  static re-reference interval prediction with 2-bit RRPVs. New lines are
+///                 inserted with a long re-reference interval, hits promote them.
+/// * `ReplBrrip`:  bimodal RRIP, new lines are mostly inserted with a distant re-reference
+///                 interval. Lines of a single scan are evicted before the working set.
+///
+/// Ways set in `spm_lock_i` are never chosen.
+module axi_tagctrl_evict_box #(
+    /// Static LLC configuration struct
+    parameter axi_llc_pkg::llc_cfg_t Cfg = axi_llc_pkg::llc_cfg_t'{default: '0},
+    /// Replacement policy of the tag cache
+    parameter axi_tagctrl_pkg::repl_policy_e ReplPolicy = axi_tagctrl_pkg::ReplRandom,
+    /// Way indicator type
+    /// EG: typedef logic [Cfg.SetAssociativity-1:0] way_ind_t;
+    parameter type way_ind_t = logic,
+    /// Cache line index type
+    parameter type index_t = logic
+) (
+    /// Clock, positive edge triggered
+    input  logic     clk_i,
+    /// Asynchronous reset, active low
+    input  logic     rst_ni,
+    /// A victim way is requested for the cache line `index_i`.
+    input  logic     req_i,
+    /// Cache line index of the request.
+    input  index_t   index_i,
+    /// The stored tags of the ways are valid.
+    input  way_ind_t tag_valid_i,
+    /// The stored tags of the ways are dirty.
+    input  way_ind_t tag_dirty_i,
+    /// Ways which must not be chosen.
+    input  way_ind_t spm_lock_i,
+    /// Chosen victim way, one-hot.
+    output way_ind_t way_ind_o,
+    /// The victim way holds a dirty line which has to be evicted.
+    output logic     evict_o,
+    /// The victim way is valid.
+    output logic     valid_o,
+    /// Update the replacement state, a cache line was accessed.
+    input  logic     update_i,
+    /// Cache line index of the access.
+    input  index_t   update_index_i,
+    /// Accessed way, one-hot.
+    input  way_ind_t update_way_i,
+    /// The access was a hit, otherwise the way got filled with a new line.
+    input  logic     update_hit_i
+);
+  localparam int unsigned NumWays = Cfg.SetAssociativity;
+  localparam int unsigned WayIdxWidth = cf_math_pkg::idx_width(NumWays);
+  typedef logic [WayIdxWidth-1:0] way_idx_t;
+
+  // Ways which may be chosen and the ones of them which are invalid
+  way_ind_t free_ways, inv_ways;
+  way_idx_t inv_idx, free_idx, upd_idx;
+  logic inv_empty, free_empty;
+  // Victim of the replacement policy, only used when there is no invalid way
+  way_ind_t policy_way;
+  // Pseudo random number
+  logic [15:0] lfsr_d, lfsr_q;
+
+  assign free_ways = ~spm_lock_i;
+  assign inv_ways  = free_ways & ~tag_valid_i;
+
+  assign valid_o   = req_i & ~free_empty;
+  assign way_ind_o = (!inv_empty) ? way_ind_t'(1) << inv_idx : policy_way;
+  assign evict_o   = |(way_ind_o & tag_valid_i & tag_dirty_i);
+
+  // Fill the first invalid way
+  lzc #(
+      .WIDTH(NumWays),
+      .MODE (1'b0)
+  ) i_lzc_inv (
+      .in_i   (inv_ways),
+      .cnt_o  (inv_idx),
+      .empty_o(inv_empty)
+  );
+
+  // Fallback, if the policy would choose a locked way
+  lzc #(
+      .WIDTH(NumWays),
+      .MODE (1'b0)
+  ) i_lzc_free (
+      .in_i   (free_ways),
+      .cnt_o  (free_idx),
+      .empty_o(free_empty)
+  );
+
+  onehot_to_bin #(
+      .ONEHOT_WIDTH(NumWays)
+  ) i_onehot_to_bin_upd (
+      .onehot(update_way_i),
+      .bin   (upd_idx)
+  );
+
+  // Free running 16-bit LFSR, x^16 + x^14 + x^13 + x^11 + 1
+  assign lfsr_d = {lfsr_q[14:0], lfsr_q[15] ^ lfsr_q[13] ^ lfsr_q[12] ^ lfsr_q[10]};
+  `FF(lfsr_q, lfsr_d, 16'hACE1, clk_i, rst_ni)
+
+  if (ReplPolicy == axi_tagctrl_pkg::ReplPlru) begin : gen_plru
+    // One tree of `NumWays - 1` nodes per cache line. A node points to the subtree which holds
+    // the victim, `0`: left, `1`: right. Way `i` is the leaf `NumWays - 1 + i`.
+    localparam int unsigned NumNodes = NumWays - 1;
+    localparam int unsigned NumLevels = $clog2(NumWays);
+    logic [Cfg.NumLines-1:0][NumNodes-1:0] plru_d, plru_q;
+
+    always_comb begin : proc_plru_victim
+      automatic int unsigned node = 0;
+      for (int unsigned l = 0; l < NumLevels; l++) begin
+        node = 2 * node + 1 + int'(plru_q[index_i][node]);
+      end
+      policy_way = free_ways[node-NumNodes] ? way_ind_t'(1) << (node - NumNodes) :
+                                              way_ind_t'(1) << free_idx;
+    end
+
+    always_comb begin : proc_plru_update
+      automatic int unsigned node = 0;
+      automatic logic dir;
+      plru_d = plru_q;
+      // point every node on the path of the accessed way away from it
+      for (int unsigned l = 0; l < NumLevels; l++) begin
+        dir = upd_idx[NumLevels-1-l];
+        plru_d[update_index_i][node] = ~dir;
+        node = 2 * node + 1 + int'(dir);
+      end
+    end
+
+    `FFLARN(plru_q, plru_d, update_i, '0, clk_i, rst_ni)
+
+    // pragma translate_off
+`ifndef VERILATOR
+    initial begin : proc_check_params
+      plru_ways :
+      assert ((NumWays > 32'd1) && (NumWays == 2 ** NumLevels))
+      else $fatal(1, "Tree-PLRU replacement needs a power of two set-associativity > 1!");
+    end
+`endif
+    // pragma translate_on
+  end else if ((ReplPolicy == axi_tagctrl_pkg::ReplSrrip) ||
+               (ReplPolicy == axi_tagctrl_pkg::ReplBrrip)) begin : gen_rrip
+    // 2-bit re-reference prediction value per way, `3` is the most distant re-reference
+    typedef logic [1:0] rrpv_t;
+    localparam rrpv_t RrpvDistant = 2'd3;
+    localparam rrpv_t RrpvLong = 2'd2;
+    rrpv_t [Cfg.NumLines-1:0][NumWays-1:0] rrpv_d, rrpv_q;
+    // Aging of the cache line, applied when the victim gets filled
+    rrpv_t age;
+
+    always_comb begin : proc_rrip_victim
+      automatic rrpv_t max_rrpv = '0;
+      policy_way = way_ind_t'(1) << free_idx;
+      for (int unsigned i = 0; i < NumWays; i++) begin
+        if (free_ways[i] && (rrpv_q[index_i][i] > max_rrpv)) begin
+          max_rrpv = rrpv_q[index_i][i];
+        end
+      end
+      // the first free way with the most distant re-reference
+      for (int unsigned i = NumWays; i > 0; i--) begin
+        if (free_ways[i-1] && (rrpv_q[index_i][i-1] == max_rrpv)) begin
+          policy_way = way_ind_t'(1) << (i - 1);
+        end
+      end
+    end
+
+    // Age the line until its most distant way predicts a distant re-reference, as the victim
+    // search of RRIP does. The filled way is not always that way, it can also have been invalid.
+    always_comb begin : proc_rrip_age
+      automatic rrpv_t max_rrpv = '0;
+      for (int unsigned i = 0; i < NumWays; i++) begin
+        if (free_ways[i] && (rrpv_q[update_index_i][i] > max_rrpv)) begin
+          max_rrpv = rrpv_q[update_index_i][i];
+        end
+      end
+      age = RrpvDistant - max_rrpv;
+    end
+
+    always_comb begin : proc_rrip_update
+      rrpv_d = rrpv_q;
+      if (update_hit_i) begin
+        rrpv_d[update_index_i][upd_idx] = '0;
+      end else begin
+        for (int unsigned i = 0; i < NumWays; i++) begin
+          rrpv_d[update_index_i][i] = (rrpv_q[update_index_i][i] > RrpvDistant - age) ?
+              RrpvDistant : rrpv_q[update_index_i][i] + age;
+        end
+        if (ReplPolicy == axi_tagctrl_pkg::ReplBrrip) begin
+          // insert with a long re-reference interval only once in 32 fills
+          rrpv_d[update_index_i][upd_idx] = (lfsr_q[4:0] == '0) ? RrpvLong : RrpvDistant;
+        end else begin
+          rrpv_d[update_index_i][upd_idx] = RrpvLong;
+        end
+      end
+    end
+
+    `FFLARN(rrpv_q, rrpv_d, update_i, '1, clk_i, rst_ni)
+  end else begin : gen_random
+    // first free way starting at a random one
+    always_comb begin : proc_random_victim
+      automatic int unsigned start = int'(lfsr_q) % NumWays;
+      policy_way = '0;
+      for (int unsigned i = NumWays; i > 0; i--) begin
+        if (free_ways[(start+i-1)%NumWays]) begin
+          policy_way = way_ind_t'(1) << ((start + i - 1) % NumWays);
+        end
+      end
+    end
+  end
+
+endmodule
@@ -0,0 +1,348 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+`include "common_cells/registers.svh"
+
+/// Eviction unit of the sectored tag cache.
+///
+/// Writes back only the dirty blocks `desc_i.evict_blk` of an evicted or flushed cache line. One
+/// AW burst is made per line, spanning from the first to the last dirty block. The blocks in the
+/// span are read from the ways, W beats of blocks which are not dirty have all strobes cleared.
+/// The descriptor is sent to the refill unit once the AW and the last W beat of its write back are
+/// sent. Up to `EvictDepth` write backs wait for their B response in the background, all AWs use
+/// the same ID and the B responses return in order. Memory only orders a read after a write to
+/// the same address once the B response arrived, a descriptor which refills the line of a write
+/// back in flight is held until then.
+///
+/// Flush descriptors end here, `flush_desc_recv_o` pulses once per flush descriptor, with the B
+/// response of its write back. Descriptors without `evict` pass through.
+module axi_tagctrl_evict_unit #(
+    /// Static LLC configuration struct
+    parameter axi_llc_pkg::llc_cfg_t Cfg = axi_llc_pkg::llc_cfg_t'{default: '0},
+    /// AXI parameter configuration
+    parameter axi_llc_pkg::llc_axi_cfg_t AxiCfg = axi_llc_pkg::llc_axi_cfg_t'{default: '0},
+    /// Descriptor type
+    parameter type desc_t = logic,
+    /// Data way request payload type
+    parameter type way_inp_t = logic,
+    /// Data way response payload type
+    parameter type way_oup_t = logic,
+    /// AXI AW channel payload type
+    parameter type aw_chan_t = logic,
+    /// AXI W channel payload type
+    parameter type w_chan_t = logic,
+    /// AXI B channel payload type
+    parameter type b_chan_t = logic
+) (
+    /// Clock, positive edge triggered
+    input  logic     clk_i,
+    /// Asynchronous reset, active low
+    input  logic     rst_ni,
+    /// Testmode enable
+    input  logic     test_i,
+    /// Input descriptor payload
+    input  desc_t    desc_i,
+    /// Input descriptor is valid
+    input  logic     desc_valid_i,
+    /// Unit is ready to accept a new descriptor
+    output logic     desc_ready_o,
+    /// Output descriptor payload
+    output desc_t    desc_o,
+    /// Output descriptor is valid
+    output logic     desc_valid_o,
+    /// Next unit is ready to accept the output descriptor
+    input  logic     desc_ready_i,
+    /// Data way request payload, reads the evicted blocks
+    output way_inp_t way_inp_o,
+    /// Data way request is valid
+    output logic     way_inp_valid_o,
+    /// Data way is ready to accept a request
+    input  logic     way_inp_ready_i,
+    /// Data way response payload
+    input  way_oup_t way_out_i,
+    /// Data way response is valid
+    input  logic     way_out_valid_i,
+    /// Unit is ready to accept the data way response
+    output logic     way_out_ready_o,
+    /// AXI AW channel payload
+    output aw_chan_t aw_chan_mst_o,
+    /// AXI AW channel is valid
+    output logic     aw_chan_valid_o,
+    /// AXI AW channel is ready
+    input  logic     aw_chan_ready_i,
+    /// AXI W channel payload
+    output w_chan_t  w_chan_mst_o,
+    /// AXI W channel is valid
+    output logic     w_chan_valid_o,
+    /// AXI W channel is ready
+    input  logic     w_chan_ready_i,
+    /// AXI B channel payload
+    input  b_chan_t  b_chan_mst_i,
+    /// AXI B channel is valid
+    input  logic     b_chan_valid_i,
+    /// AXI B channel is ready
+    output logic     b_chan_ready_o,
+    /// A flush descriptor was received, pulses once per flush descriptor
+    output logic     flush_desc_recv_o
+);
+
+  /// Number of write backs with an outstanding B response, a power of two.
+  localparam int unsigned EvictDepth = 32'd4;
+
+  localparam int unsigned IndexBase = Cfg.ByteOffsetLength + Cfg.BlockOffsetLength;
+  localparam int unsigned TagBase = IndexBase + Cfg.IndexLength;
+
+  typedef logic [Cfg.BlockOffsetLength-1:0] offset_t;
+  typedef logic [Cfg.NumBlocks-1:0] blk_t;
+  // tag and index of a cache line
+  typedef logic [Cfg.TagLength+Cfg.IndexLength-1:0] line_t;
+  typedef logic [$clog2(EvictDepth)-1:0] wb_ptr_t;
+
+  typedef enum logic [1:0] {
+    Idle,   // wait for a descriptor
+    Evict,  // make the AW, read the blocks from the ways and send them as W beats
+    Send    // send the descriptor to the refill unit
+  } evict_state_e;
+
+  evict_state_e state_d, state_q;
+  logic load_state;
+  desc_t desc_d, desc_q;
+  logic load_desc;
+  // the AW of the write back was sent
+  logic aw_sent_d, aw_sent_q, load_aw_sent;
+  // block offsets of the next way read and the next W beat
+  offset_t rd_blk_d, rd_blk_q, wr_blk_d, wr_blk_q, last_blk_q;
+  logic load_rd_blk, load_wr_blk;
+  // all blocks of the span are read from the ways
+  logic rd_done_d, rd_done_q, load_rd_done;
+  // the last W beat of the write back was sent
+  logic w_done_d, w_done_q, load_w_done;
+
+  // Write backs in the order of their AWs, until their B response arrived
+  line_t [EvictDepth-1:0] wb_line_d, wb_line_q;
+  logic [EvictDepth-1:0] wb_flush_d, wb_flush_q, wb_valid_d, wb_valid_q;
+  wb_ptr_t wb_wr_q, wb_rd_q;
+  logic wb_push, wb_pop, wb_full;
+  // the descriptor refills the line of a write back in flight
+  logic wb_hazard;
+
+  function automatic offset_t first_blk(blk_t blk);
+    offset_t first = '0;
+    for (int i = Cfg.NumBlocks - 1; i >= 0; i--) begin
+      if (blk[i]) first = offset_t'(i);
+    end
+    return first;
+  endfunction
+
+  function automatic offset_t last_blk(blk_t blk);
+    offset_t last = '0;
+    for (int i = 0; i < Cfg.NumBlocks; i++) begin
+      if (blk[i]) last = offset_t'(i);
+    end
+    return last;
+  endfunction
+
+  assign desc_o = desc_q;
+
+  assign wb_full = wb_valid_q[wb_wr_q];
+
+  always_comb begin : proc_wb
+    wb_line_d  = wb_line_q;
+    wb_flush_d = wb_flush_q;
+    wb_valid_d = wb_valid_q;
+    if (wb_pop) begin
+      wb_valid_d[wb_rd_q] = 1'b0;
+    end
+    if (wb_push) begin
+      wb_line_d[wb_wr_q]  = {desc_q.evict_tag, desc_q.a_x_addr[IndexBase+:Cfg.IndexLength]};
+      wb_flush_d[wb_wr_q] = desc_q.flush;
+      wb_valid_d[wb_wr_q] = 1'b1;
+    end
+  end
+
+  always_comb begin : proc_wb_hazard
+    wb_hazard = 1'b0;
+    for (int unsigned i = 0; i < EvictDepth; i++) begin
+      if (desc_q.refill && wb_valid_q[i] &&
+          (wb_line_q[i] == desc_q.a_x_addr[IndexBase+:(Cfg.TagLength+Cfg.IndexLength)])) begin
+        wb_hazard = 1'b1;
+      end
+    end
+  end
+
+  // AW of the span of dirty blocks, in the line of the evicted tag
+  always_comb begin : proc_aw_chan
+    aw_chan_mst_o = '0;
+    aw_chan_mst_o.addr = desc_q.a_x_addr;
+    aw_chan_mst_o.addr[TagBase+:Cfg.TagLength] = desc_q.evict_tag;
+    aw_chan_mst_o.addr[IndexBase-1:0] = {
+      first_blk(desc_q.evict_blk), {Cfg.ByteOffsetLength{1'b0}}
+    };
+    aw_chan_mst_o.len = axi_pkg::len_t'(last_blk_q - first_blk(desc_q.evict_blk));
+    aw_chan_mst_o.size = axi_pkg::size_t'($clog2(Cfg.BlockSize / 32'd8));
+    aw_chan_mst_o.burst = axi_pkg::BURST_INCR;
+  end
+
+  assign way_inp_o = way_inp_t'{
+      cache_unit: axi_llc_pkg::EvictUnit,
+      way_ind:    desc_q.way_ind,
+      line_addr:  desc_q.a_x_addr[IndexBase+:Cfg.IndexLength],
+      blk_offset: rd_blk_q,
+      we:         1'b0,
+      default:    '0
+  };
+
+  // W beats of clean blocks in the span do not write
+  always_comb begin : proc_w_chan
+    w_chan_mst_o      = '0;
+    w_chan_mst_o.data = way_out_i.data;
+    w_chan_mst_o.strb = desc_q.evict_blk[wr_blk_q] ? '1 : '0;
+    w_chan_mst_o.last = (wr_blk_q == last_blk_q);
+  end
+
+  always_comb begin : proc_evict_ctrl
+    state_d           = state_q;
+    load_state        = 1'b0;
+    desc_d            = desc_q;
+    load_desc         = 1'b0;
+    aw_sent_d         = aw_sent_q;
+    load_aw_sent      = 1'b0;
+    rd_blk_d          = rd_blk_q;
+    load_rd_blk       = 1'b0;
+    wr_blk_d          = wr_blk_q;
+    load_wr_blk       = 1'b0;
+    rd_done_d         = rd_done_q;
+    load_rd_done      = 1'b0;
+    w_done_d          = w_done_q;
+    load_w_done       = 1'b0;
+    wb_push           = 1'b0;
+    wb_pop            = 1'b0;
+    desc_ready_o      = 1'b0;
+    desc_valid_o      = 1'b0;
+    aw_chan_valid_o   = 1'b0;
+    way_inp_valid_o   = 1'b0;
+    way_out_ready_o   = 1'b0;
+    w_chan_valid_o    = 1'b0;
+    b_chan_ready_o    = 1'b0;
+    flush_desc_recv_o = 1'b0;
+
+    // B responses return in the order of the AWs, a flush is done with its write back
+    b_chan_ready_o = wb_valid_q[wb_rd_q];
+    if (b_chan_valid_i && b_chan_ready_o) begin
+      wb_pop            = 1'b1;
+      flush_desc_recv_o = wb_flush_q[wb_rd_q];
+    end
+
+    // the AW stays valid until it is accepted, independent of the W beats
+    if ((state_q == Evict) && !aw_sent_q && !wb_full) begin
+      aw_chan_valid_o = 1'b1;
+      if (aw_chan_ready_i) begin
+        aw_sent_d    = 1'b1;
+        load_aw_sent = 1'b1;
+        wb_push      = 1'b1;
+      end
+    end
+
+    unique case (state_q)
+      Idle: load_new_desc();
+      Evict: begin
+        // read the blocks of the span from the ways
+        way_inp_valid_o = !rd_done_q;
+        if (way_inp_valid_o && way_inp_ready_i) begin
+          if (rd_blk_q == last_blk_q) begin
+            rd_done_d    = 1'b1;
+            load_rd_done = 1'b1;
+          end else begin
+            rd_blk_d    = rd_blk_q + offset_t'(1);
+            load_rd_blk = 1'b1;
+          end
+        end
+        // and send them in order as W beats
+        w_chan_valid_o  = way_out_valid_i && !w_done_q;
+        way_out_ready_o = w_chan_ready_i && !w_done_q;
+        if (w_chan_valid_o && w_chan_ready_i) begin
+          if (w_chan_mst_o.last) begin
+            w_done_d    = 1'b1;
+            load_w_done = 1'b1;
+          end else begin
+            wr_blk_d    = wr_blk_q + offset_t'(1);
+            load_wr_blk = 1'b1;
+          end
+        end
+        // the write back is issued, its B response is collected in the background
+        if (aw_sent_d && w_done_d) begin
+          state_d    = desc_q.flush ? Idle : Send;
+          load_state = 1'b1;
+        end
+      end
+      Send: begin
+        // a refill of the line of a write back in flight waits for its B response
+        desc_valid_o = !wb_hazard;
+        if (desc_valid_o && desc_ready_i) begin
+          load_new_desc();
+        end
+      end
+      default: begin
+        state_d    = Idle;
+        load_state = 1'b1;
+      end
+    endcase
+  end
+
+  // Accepts a new descriptor and chooses the next state, only used in the always_comb block above.
+  // The flush pulse of a write back which is done in this cycle goes first.
+  function void load_new_desc();
+    desc_ready_o = !flush_desc_recv_o;
+    state_d      = Idle;
+    load_state   = 1'b1;
+    if (desc_valid_i && desc_ready_o) begin
+      desc_d    = desc_i;
+      load_desc = 1'b1;
+      if (desc_i.evict) begin
+        state_d      = Evict;
+        aw_sent_d    = 1'b0;
+        load_aw_sent = 1'b1;
+        rd_done_d    = 1'b0;
+        load_rd_done = 1'b1;
+        w_done_d     = 1'b0;
+        load_w_done  = 1'b1;
+        rd_blk_d     = first_blk(desc_i.evict_blk);
+        load_rd_blk  = 1'b1;
+        wr_blk_d     = first_blk(desc_i.evict_blk);
+        load_wr_blk  = 1'b1;
+      end else if (desc_i.flush) begin
+        // nothing to write back, the flush is done
+        flush_desc_recv_o = 1'b1;
+      end else begin
+        state_d = Send;
+      end
+    end
+  endfunction : load_new_desc
+
+  `FFLARN(state_q, state_d, load_state, Idle, clk_i, rst_ni)
+  `FFLARN(desc_q, desc_d, load_desc, desc_t'('0), clk_i, rst_ni)
+  `FFLARN(last_blk_q, last_blk(desc_i.evict_blk), load_desc, '0, clk_i, rst_ni)
+  `FFLARN(aw_sent_q, aw_sent_d, load_aw_sent, 1'b0, clk_i, rst_ni)
+  `FFLARN(rd_blk_q, rd_blk_d, load_rd_blk, '0, clk_i, rst_ni)
+  `FFLARN(wr_blk_q, wr_blk_d, load_wr_blk, '0, clk_i, rst_ni)
+  `FFLARN(rd_done_q, rd_done_d, load_rd_done, 1'b0, clk_i, rst_ni)
+  `FFLARN(w_done_q, w_done_d, load_w_done, 1'b0, clk_i, rst_ni)
+  `FFLARN(wb_line_q, wb_line_d, wb_push, '0, clk_i, rst_ni)
+  `FFLARN(wb_flush_q, wb_flush_d, wb_push, '0, clk_i, rst_ni)
+  `FF(wb_valid_q, wb_valid_d, '0, clk_i, rst_ni)
+  `FFLARN(wb_wr_q, wb_wr_q + wb_ptr_t'(1), wb_push, '0, clk_i, rst_ni)
+  `FFLARN(wb_rd_q, wb_rd_q + wb_ptr_t'(1), wb_pop, '0, clk_i, rst_ni)
+
+  // pragma translate_off
+`ifndef VERILATOR
+  evict_blk: assert property (@(posedge clk_i) disable iff (!rst_ni)
+      (desc_valid_i && desc_i.evict) |-> (desc_i.evict_blk != '0))
+  else $fatal(1, "An evicting descriptor has to write back at least one block!");
+`endif
+  // pragma translate_on
+
+endmodule
@@ -0,0 +1,229 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+/// Background flush unit of the tag cache.
+///
+/// Writes back dirty tag lines while the tag controller keeps serving requests. Contrary to a
+/// flush through `CfgFlush` of (module.axi_tagctrl_config) the slave port is not isolated and
+/// the lines are cleaned instead of invalidated, they stay in the tag cache.
+///
+/// The unit mirrors the dirty bits of the tag storage from the results of the hit miss unit, so
+/// that only dirty lines are visited. A flush either walks over every index of the tag cache or,
+/// in range mode, over the tag lines covering a physical address range. Range flush descriptors
+/// carry the tag line address and only clean a line holding this tag. A range covering at least
+/// as many tag lines as the tag cache has indices is flushed as a whole.
+///
+/// The cleaning descriptors are flush descriptors with `clean` set. They take the miss path of
+/// the tag cache, the eviction unit writes the line back and signals `flush_desc_recv_i`.
+/// Lines which get dirty again during a flush are not guaranteed to be written back by it.
+module axi_tagctrl_flush_unit #(
+    /// Tag Controller configuration struct. Passed down from `axi_tagctrl_top.sv`.
+    parameter axi_tagctrl_pkg::tagctrl_cfg_t Cfg = axi_tagctrl_pkg::tagctrl_cfg_t'{default: '0},
+    /// Tag cache descriptor type
+    parameter type desc_t = logic,
+    /// Way indicator type
+    parameter type way_ind_t = logic
+) (
+    /// Clock, positive edge triggered
+    input  logic                             clk_i,
+    /// Asynchronous reset, active low
+    input  logic                             rst_ni,
+    /// Flush configuration from the register file
+    input  axi_tagctrl_pkg::flush_cfg_t      flush_i,
+    /// The flush is running or has descriptors in flight.
+    output logic                             busy_o,
+    /// A cleaning descriptor found its line dirty, the line gets written back.
+    output logic                             line_o,
+    /// Descriptors are still in flight, `axi_tagctrl_config` waits for them before it flushes.
+    output logic                             inflight_o,
+    /// Do not issue new descriptors, `axi_tagctrl_config` is flushing.
+    input  logic                             pause_i,
+    /// Result of a tag lookup, from the hit miss unit
+    input  desc_t                            lookup_desc_i,
+    /// The lookup result left the hit miss unit
+    input  logic                             lookup_valid_i,
+    /// Flush descriptor output
+    output desc_t                            desc_o,
+    /// Flush descriptor is valid
+    output logic                             desc_valid_o,
+    /// Flush descriptor is accepted
+    input  logic                             desc_ready_i,
+    /// A flush descriptor left the eviction unit
+    input  logic                             flush_desc_recv_i
+);
+  `include "common_cells/registers.svh"
+
+  localparam int unsigned NumWays = Cfg.tagc_cfg.SetAssociativity;
+  localparam int unsigned NumLines = Cfg.tagc_cfg.NumLines;
+  localparam int unsigned IndexBase = Cfg.tagc_cfg.ByteOffsetLength +
+                                      Cfg.tagc_cfg.BlockOffsetLength;
+  /// Bytes of tag storage in one tag cache line
+  localparam int unsigned LineBytes = Cfg.tagc_cfg.NumBlocks * Cfg.tagc_cfg.BlockSize / 32'd8;
+  /// Data bytes covered by one tag word
+  localparam int unsigned TagWordCover = Cfg.tagc_cfg.BlockSize * (Cfg.CapSize / 32'd8);
+
+  typedef logic [Cfg.AxiAddrWidth-1:0] addr_t;
+  typedef logic [Cfg.tagc_cfg.IndexLength-1:0] index_t;
+  typedef logic [cf_math_pkg::idx_width(NumWays)-1:0] way_idx_t;
+  /// Counter of in-flight descriptors, there can not be more than one per line
+  typedef logic [$clog2(NumWays*NumLines+1)-1:0] inflight_t;
+
+  // Dirty bits of all ways, per index
+  way_ind_t [NumLines-1:0] dirty_d, dirty_q;
+  index_t lookup_index;
+
+  // Walk state
+  logic walk_d, walk_q, match_d, match_q;
+  addr_t line_d, line_q, last_d, last_q;
+  way_ind_t sent_d, sent_q;
+  index_t walk_index;
+  way_ind_t to_send;
+  way_idx_t to_send_idx;
+  logic to_send_empty;
+
+  // Output descriptor
+  desc_t desc_d, desc_q;
+  logic valid_d, valid_q;
+  inflight_t inflight_d, inflight_q;
+
+  // Address of the tag line holding the tags of `addr`
+  function automatic addr_t tag_line_addr(addr_t addr);
+    addr_t tag_off;
+    tag_off = (addr - addr_t'(Cfg.DRAMMemBase)) / addr_t'(TagWordCover);
+    return (addr_t'(Cfg.TagCacheMemBase) + (tag_off << $clog2(Cfg.tagc_cfg.BlockSize / 8))) &
+           ~addr_t'(LineBytes - 1);
+  endfunction
+
+  ///////////////////
+  // Dirty mirror //
+  ///////////////////
+  assign lookup_index = lookup_desc_i.a_x_addr[IndexBase+:Cfg.tagc_cfg.IndexLength];
+
+  always_comb begin : proc_dirty
+    dirty_d = dirty_q;
+    if (lookup_valid_i) begin
+      if (lookup_desc_i.flush) begin
+        // cleaned or invalidated
+        dirty_d[lookup_index] &= ~lookup_desc_i.way_ind;
+      end else if (lookup_desc_i.rw) begin
+        dirty_d[lookup_index] |= lookup_desc_i.way_ind;
+      end else if (lookup_desc_i.refill) begin
+        // a read refilled the way with a clean line
+        dirty_d[lookup_index] &= ~lookup_desc_i.way_ind;
+      end
+    end
+  end
+
+  `FFLARN(dirty_q, dirty_d, lookup_valid_i, '0, clk_i, rst_ni)
+
+  assign line_o = lookup_valid_i & lookup_desc_i.clean & lookup_desc_i.evict;
+
+  //////////
+  // Walk //
+  //////////
+  assign walk_index = match_q ? line_q[IndexBase+:Cfg.tagc_cfg.IndexLength] : index_t'(line_q);
+  assign to_send    = dirty_q[walk_index] & ~sent_q;
+
+  lzc #(
+      .WIDTH(NumWays),
+      .MODE (1'b0)
+  ) i_lzc_to_send (
+      .in_i   (to_send),
+      .cnt_o  (to_send_idx),
+      .empty_o(to_send_empty)
+  );
+
+  always_comb begin : proc_walk
+    walk_d  = walk_q;
+    match_d = match_q;
+    line_d  = line_q;
+    last_d  = last_q;
+    sent_d  = sent_q;
+    desc_d  = desc_q;
+    valid_d = valid_q;
+
+    if (valid_q && desc_ready_i) begin
+      valid_d = 1'b0;
+    end
+
+    if (!walk_q) begin
+      if (flush_i.start) begin
+        walk_d  = 1'b1;
+        sent_d  = '0;
+        match_d = 1'b0;
+        line_d  = '0;
+        last_d  = addr_t'(NumLines - 1);
+        if (flush_i.range) begin
+          if (flush_i.end_addr <= flush_i.start_addr) begin
+            // empty range
+            walk_d = 1'b0;
+          end else if (((tag_line_addr(addr_t'(flush_i.end_addr - 1)) -
+                         tag_line_addr(addr_t'(flush_i.start_addr))) / LineBytes) <
+                       addr_t'(NumLines - 1)) begin
+            // the range maps onto less lines than there are indices, visit only its lines
+            match_d = 1'b1;
+            line_d  = tag_line_addr(addr_t'(flush_i.start_addr));
+            last_d  = tag_line_addr(addr_t'(flush_i.end_addr - 1));
+          end
+        end
+      end
+    end else if (!pause_i && (!valid_q || desc_ready_i)) begin
+      if (!to_send_empty) begin
+        // clean the next dirty way of this index
+        desc_d = '0;
+        desc_d.a_x_id    = axi_tagctrl_pkg::AxReqId;
+        desc_d.a_x_addr  = match_q ? line_q : addr_t'(line_q) << IndexBase;
+        desc_d.a_x_len   = axi_pkg::len_t'(Cfg.tagc_cfg.NumBlocks - 32'd1);
+        desc_d.a_x_size  = axi_pkg::size_t'($clog2(Cfg.tagc_cfg.BlockSize / 32'd8));
+        desc_d.a_x_burst = axi_pkg::BURST_INCR;
+        desc_d.x_resp    = axi_pkg::RESP_OKAY;
+        desc_d.way_ind   = way_ind_t'(1) << to_send_idx;
+        desc_d.flush     = 1'b1;
+        desc_d.clean     = 1'b1;
+        desc_d.clean_match = match_q;
+        valid_d          = 1'b1;
+        sent_d           = sent_q | desc_d.way_ind;
+      end else begin
+        // all dirty ways of this line are sent
+        sent_d = '0;
+        if (line_q == last_q) begin
+          walk_d = 1'b0;
+        end else begin
+          line_d = match_q ? line_q + addr_t'(LineBytes) : line_q + addr_t'(1);
+        end
+      end
+    end
+  end
+
+  `FF(walk_q, walk_d, 1'b0, clk_i, rst_ni)
+  `FF(match_q, match_d, 1'b0, clk_i, rst_ni)
+  `FF(line_q, line_d, '0, clk_i, rst_ni)
+  `FF(last_q, last_d, '0, clk_i, rst_ni)
+  `FF(sent_q, sent_d, '0, clk_i, rst_ni)
+  `FF(desc_q, desc_d, '0, clk_i, rst_ni)
+  `FF(valid_q, valid_d, 1'b0, clk_i, rst_ni)
+
+  // Descriptors between the output and the eviction unit. While this unit has descriptors in
+  // flight, `axi_tagctrl_config` does not flush, all `flush_desc_recv_i` belong to this unit.
+  always_comb begin : proc_inflight
+    inflight_d = inflight_q;
+    if (valid_q && desc_ready_i) begin
+      inflight_d = inflight_d + inflight_t'(1);
+    end
+    if (flush_desc_recv_i && (inflight_q != '0)) begin
+      inflight_d = inflight_d - inflight_t'(1);
+    end
+  end
+
+  `FF(inflight_q, inflight_d, '0, clk_i, rst_ni)
+
+  assign desc_o       = desc_q;
+  assign desc_valid_o = valid_q;
+  assign inflight_o   = valid_q | (inflight_q != '0);
+  assign busy_o       = walk_q | inflight_o;
+
+endmodule
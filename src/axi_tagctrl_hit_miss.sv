@@ -0,0 +1,383 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+`include "common_cells/registers.svh"
+
+/// Hit miss detection unit of the tag cache.
+///
+/// Performs the tag lookup of every descriptor in (module.axi_tagctrl_tag_store) and routes the
+/// descriptor onto the hit or the miss path. The victim way of a miss is chosen with the
+/// replacement policy `ReplPolicy`.
+///
+/// The unit keeps the ordering guarantees of `axi_llc_hit_miss`:
+/// * A cache line which has a descriptor in flight is held in a miss status holding register
+///   (MSHR) until the read or write unit unlocks it.
+/// * A hit is sent down the miss path as long as a miss of the same direction and ID is still in
+///   the eviction / refill pipeline, so that it can not overtake it.
+///
+/// The lookup pipeline does not block behind an in-flight miss:
+/// * Ways held by an MSHR are never chosen as victim, a miss allocates in another way of the
+///   cache line instead of waiting for the unrelated line to be released.
+/// * A secondary access to a line with an MSHR of the same direction merges into the entry and
+///   follows the primary one down the miss path, without an eviction of its own. It only refills
+///   the blocks of the sectored line which neither are valid nor being refilled. The read and write
+///   units process their descriptors in order, so it observes the refilled line.
+///   Only accesses of the other direction wait for the line to be released.
+///
+/// After reset the BIST of the tag storage is run once before the first lookup.
+module axi_tagctrl_hit_miss #(
+    /// Static LLC configuration struct
+    parameter axi_llc_pkg::llc_cfg_t Cfg = axi_llc_pkg::llc_cfg_t'{default: '0},
+    /// AXI parameter configuration
+    parameter axi_llc_pkg::llc_axi_cfg_t AxiCfg = axi_llc_pkg::llc_axi_cfg_t'{default: '0},
+    /// Replacement policy of the tag cache
+    parameter axi_tagctrl_pkg::repl_policy_e ReplPolicy = axi_tagctrl_pkg::ReplRandom,
+    /// Descriptor type
+    parameter type desc_t = logic,
+    /// Lock struct type of the read and write unit
+    parameter type lock_t = logic,
+    /// Miss counter decrement struct type
+    parameter type cnt_t = logic,
+    /// Way indicator type
+    /// EG: typedef logic [Cfg.SetAssociativity-1:0] way_ind_t;
+    parameter type way_ind_t = logic,
+    /// Whether to print SRAM configs
+    parameter bit PrintSramCfg = 0
+) (
+    /// Clock, positive edge triggered
+    input  logic     clk_i,
+    /// Asynchronous reset, active low
+    input  logic     rst_ni,
+    /// Testmode enable
+    input  logic     test_i,
+    /// Descriptor which gets looked up.
+    input  desc_t    desc_i,
+    /// Input descriptor is valid.
+    input  logic     valid_i,
+    /// Unit is ready to accept a descriptor.
+    output logic     ready_o,
+    /// Descriptor with the result of the lookup.
+    output desc_t    desc_o,
+    /// Output descriptor goes onto the miss path.
+    output logic     miss_valid_o,
+    /// Miss path is ready.
+    input  logic     miss_ready_i,
+    /// Output descriptor goes onto the hit path.
+    output logic     hit_valid_o,
+    /// Hit path is ready.
+    input  logic     hit_ready_i,
+    /// Ways a miss must not allocate in.
+    input  way_ind_t spm_lock_i,
+    /// Flushed ways, no lookups are performed in them.
+    input  way_ind_t flushed_i,
+    /// Line unlock of the write unit.
+    input  lock_t    w_unlock_i,
+    /// The write unit unlocks a line.
+    input  logic     w_unlock_req_i,
+    /// The write unit may unlock a line.
+    output logic     w_unlock_gnt_o,
+    /// Line unlock of the read unit.
+    input  lock_t    r_unlock_i,
+    /// The read unit unlocks a line.
+    input  logic     r_unlock_req_i,
+    /// The read unit may unlock a line.
+    output logic     r_unlock_gnt_o,
+    /// A miss left the eviction / refill pipeline.
+    input  cnt_t     cnt_down_i,
+    /// BIST result of the tag storage macros.
+    output way_ind_t bist_res_o,
+    /// BIST result is valid.
+    output logic     bist_valid_o
+);
+  /// Number of miss status holding registers, lines which can be in flight at the same time.
+  localparam int unsigned NumMshr = axi_tagctrl_pkg::TagcNumMshr;
+  /// Width of the MSHR descriptor counter, defines how many accesses can merge into an entry.
+  localparam int unsigned MshrCntWidth = 32'd3;
+  /// Number of miss counters per direction, the AXI IDs are hashed onto them.
+  localparam int unsigned NumMissCnt = 32'd4;
+  /// Width of a miss counter, defines the maximum number of outstanding misses.
+  localparam int unsigned MissCntWidth = 32'd4;
+
+  localparam int unsigned IndexBase = Cfg.ByteOffsetLength + Cfg.BlockOffsetLength;
+  localparam int unsigned TagBase = IndexBase + Cfg.IndexLength;
+  localparam int unsigned CntIdxWidth = cf_math_pkg::idx_width(NumMissCnt);
+
+  typedef logic [Cfg.IndexLength-1:0] index_t;
+  typedef logic [Cfg.TagLength-1:0] tag_t;
+  typedef logic [Cfg.NumBlocks-1:0] blk_t;
+  typedef logic [MissCntWidth-1:0] miss_cnt_t;
+  typedef logic [CntIdxWidth:0] cnt_idx_t;
+
+  typedef struct packed {
+    axi_llc_pkg::tag_mode_e mode;
+    tag_t                   tag;
+    index_t                 index;
+    way_ind_t               indicator;
+    logic                   dirty;
+    blk_t                   blk;    // blocks of the line the descriptor accesses
+    blk_t                   fetch;  // blocks to refill on a miss, `blk` and its neighbours
+    logic                   clean;  // flush: keep the line valid, only write it back
+    logic                   match;  // flush: only clean the line if it holds `tag`
+  } store_req_t;
+
+  typedef struct packed {
+    way_ind_t indicator;
+    logic     hit;
+    logic     evict;
+    tag_t     evict_tag;
+    blk_t     evict_blk;   // dirty blocks of the evicted line
+    blk_t     refill_blk;  // blocks to refill
+  } store_res_t;
+
+  typedef logic [MshrCntWidth-1:0] mshr_cnt_t;
+
+  typedef struct packed {
+    logic      valid;    // the entry holds a line
+    index_t    index;    // cache line index
+    way_ind_t  way_ind;  // way of the line
+    logic      rw;       // direction of the merged descriptors
+    logic      miss;     // a descriptor of the entry was sent down the miss path
+    mshr_cnt_t cnt;      // number of descriptors in flight
+  } mshr_t;
+
+  // Descriptor which is looked up
+  desc_t desc_q;
+  logic busy_d, busy_q, load_busy, load_desc;
+  // The BIST request was sent to the tag storage
+  logic bist_sent_q;
+  // Tag storage
+  store_req_t store_req;
+  store_res_t store_res;
+  logic store_req_valid, store_req_ready, store_res_valid, store_res_ready;
+  // Miss status holding registers
+  mshr_t [NumMshr-1:0] mshr_d, mshr_q;
+  logic [NumMshr-1:0] mshr_valid, mshr_match;
+  logic [cf_math_pkg::idx_width(NumMshr)-1:0] free_mshr;
+  logic mshr_full, line_locked, line_merge, merge_miss;
+  // Ways of the looked up cache line which are held by an MSHR
+  way_ind_t mshr_ways;
+  // Outstanding misses
+  miss_cnt_t [2*NumMissCnt-1:0] miss_cnt_d, miss_cnt_q;
+  cnt_idx_t cnt_idx, cnt_down_idx;
+  // Output handshake
+  logic out_hs;
+
+  // Blocks `first` to `last` of a cache line, clipped to the line
+  function automatic blk_t blk_range(int first, int last);
+    blk_t blk = '0;
+    for (int i = 0; i < Cfg.NumBlocks; i++) begin
+      blk[i] = (i >= first) && (i <= last);
+    end
+    return blk;
+  endfunction
+
+  function automatic cnt_idx_t miss_cnt_idx(logic rw, logic [AxiCfg.SlvPortIdWidth-1:0] id);
+    return {rw, id[CntIdxWidth-1:0]};
+  endfunction
+
+  assign out_hs = (hit_valid_o && hit_ready_i) || (miss_valid_o && miss_ready_i);
+
+  // Blocks accessed by the descriptor, a descriptor never crosses a cache line
+  int blk_first, blk_last;
+  assign blk_first = int'(desc_i.a_x_addr[Cfg.ByteOffsetLength+:Cfg.BlockOffsetLength]);
+  assign blk_last  = blk_first + int'(desc_i.a_x_len);
+
+  // Lookup request
+  always_comb begin : proc_lookup
+    ready_o         = 1'b0;
+    load_desc       = 1'b0;
+    busy_d          = busy_q;
+    load_busy       = 1'b0;
+    store_req_valid = 1'b0;
+    store_req = store_req_t'{
+        mode:      desc_i.flush ? axi_llc_pkg::Flush : axi_llc_pkg::Lookup,
+        tag:       desc_i.a_x_addr[TagBase+:Cfg.TagLength],
+        index:     desc_i.a_x_addr[IndexBase+:Cfg.IndexLength],
+        indicator: desc_i.flush ? desc_i.way_ind : ~flushed_i,
+        dirty:     desc_i.rw,
+        blk:       blk_range(blk_first, blk_last),
+        fetch:     blk_range(blk_first - int'(axi_tagctrl_pkg::TagcRefillNeighbours),
+                             blk_last + int'(axi_tagctrl_pkg::TagcRefillNeighbours)),
+        clean:     desc_i.clean,
+        match:     desc_i.clean_match
+    };
+
+    if (!bist_sent_q) begin
+      // test the storage macros first
+      store_req       = store_req_t'{mode: axi_llc_pkg::Bist, default: '0};
+      store_req_valid = 1'b1;
+    end else if (!busy_q || out_hs) begin
+      store_req_valid = valid_i;
+      ready_o         = store_req_ready;
+      if (valid_i && store_req_ready) begin
+        load_desc = 1'b1;
+        busy_d    = 1'b1;
+        load_busy = 1'b1;
+      end else if (out_hs) begin
+        busy_d    = 1'b0;
+        load_busy = 1'b1;
+      end
+    end
+  end
+
+  `FFLARN(desc_q, desc_i, load_desc, desc_t'('0), clk_i, rst_ni)
+  `FFLARN(busy_q, busy_d, load_busy, 1'b0, clk_i, rst_ni)
+  `FFLARN(bist_sent_q, 1'b1, store_req_valid & store_req_ready, 1'b0, clk_i, rst_ni)
+
+  // Result of the lookup
+  assign cnt_idx = miss_cnt_idx(desc_q.rw, desc_q.a_x_id);
+
+  always_comb begin : proc_result
+    desc_o            = desc_q;
+    desc_o.way_ind    = store_res.indicator;
+    desc_o.evict      = store_res.evict;
+    desc_o.evict_tag  = store_res.evict_tag;
+    desc_o.evict_blk  = store_res.evict_blk;
+    desc_o.refill     = !store_res.hit && !desc_q.flush;
+    desc_o.refill_blk = store_res.refill_blk;
+    hit_valid_o       = 1'b0;
+    miss_valid_o      = 1'b0;
+
+    if (busy_q && store_res_valid) begin
+      if (desc_q.flush) begin
+        // flushes are handled by the eviction unit, a cleaned line must not be in flight
+        miss_valid_o = !desc_q.clean || !(|mshr_match);
+      end else if (!line_locked && (line_merge || !mshr_full) && !(&miss_cnt_q[cnt_idx])) begin
+        if (store_res.hit && (miss_cnt_q[cnt_idx] == '0) && !merge_miss) begin
+          hit_valid_o = 1'b1;
+        end else begin
+          // misses and hits which must not overtake a miss
+          miss_valid_o = 1'b1;
+        end
+      end
+    end
+  end
+
+  assign store_res_ready = out_hs;
+
+  // Miss status holding registers
+  always_comb begin : proc_mshr_match
+    mshr_ways   = '0;
+    line_locked = 1'b0;
+    line_merge  = 1'b0;
+    merge_miss  = 1'b0;
+    for (int unsigned i = 0; i < NumMshr; i++) begin
+      mshr_valid[i] = mshr_q[i].valid;
+      mshr_match[i] = mshr_q[i].valid &&
+                      (mshr_q[i].index == desc_q.a_x_addr[IndexBase+:Cfg.IndexLength]) &&
+                      |(mshr_q[i].way_ind & store_res.indicator);
+      if (mshr_q[i].valid && (mshr_q[i].index == desc_q.a_x_addr[IndexBase+:Cfg.IndexLength])) begin
+        mshr_ways |= mshr_q[i].way_ind;
+      end
+      if (mshr_match[i]) begin
+        if ((mshr_q[i].rw == desc_q.rw) && !(&mshr_q[i].cnt)) begin
+          line_merge = 1'b1;
+          merge_miss = mshr_q[i].miss;
+        end else begin
+          line_locked = 1'b1;
+        end
+      end
+    end
+  end
+
+  lzc #(
+      .WIDTH(NumMshr),
+      .MODE (1'b0)
+  ) i_lzc_free_mshr (
+      .in_i   (~mshr_valid),
+      .cnt_o  (free_mshr),
+      .empty_o(mshr_full)
+  );
+
+  // Unlocks are always granted, they take effect in the next cycle.
+  assign w_unlock_gnt_o = 1'b1;
+  assign r_unlock_gnt_o = 1'b1;
+
+  always_comb begin : proc_mshr_update
+    mshr_d = mshr_q;
+    for (int unsigned i = 0; i < NumMshr; i++) begin
+      // a descriptor of the entry finished
+      if (mshr_q[i].valid &&
+          ((w_unlock_req_i && (mshr_q[i].index == w_unlock_i.index) &&
+            (mshr_q[i].way_ind == w_unlock_i.way_ind)) ||
+           (r_unlock_req_i && (mshr_q[i].index == r_unlock_i.index) &&
+            (mshr_q[i].way_ind == r_unlock_i.way_ind)))) begin
+        mshr_d[i].cnt = mshr_d[i].cnt - mshr_cnt_t'(1);
+      end
+      // a secondary access merges
+      if (out_hs && !desc_q.flush && mshr_match[i]) begin
+        mshr_d[i].cnt  = mshr_d[i].cnt + mshr_cnt_t'(1);
+        mshr_d[i].miss = mshr_q[i].miss | miss_valid_o;
+      end
+      mshr_d[i].valid = (mshr_d[i].cnt != '0);
+    end
+    // a primary access allocates
+    if (out_hs && !desc_q.flush && !line_merge) begin
+      mshr_d[free_mshr] = mshr_t'{
+          valid:   1'b1,
+          index:   desc_q.a_x_addr[IndexBase+:Cfg.IndexLength],
+          way_ind: store_res.indicator,
+          rw:      desc_q.rw,
+          miss:    miss_valid_o,
+          cnt:     mshr_cnt_t'(1)
+      };
+    end
+  end
+
+  `FF(mshr_q, mshr_d, '0, clk_i, rst_ni)
+
+  // Outstanding misses per direction and ID
+  assign cnt_down_idx = miss_cnt_idx(cnt_down_i.rw, cnt_down_i.id);
+
+  always_comb begin : proc_miss_cnt
+    miss_cnt_d = miss_cnt_q;
+    if (cnt_down_i.valid && (miss_cnt_d[cnt_down_idx] != '0)) begin
+      miss_cnt_d[cnt_down_idx] = miss_cnt_d[cnt_down_idx] - miss_cnt_t'(1);
+    end
+    if (miss_valid_o && miss_ready_i && !desc_q.flush) begin
+      miss_cnt_d[cnt_idx] = miss_cnt_d[cnt_idx] + miss_cnt_t'(1);
+    end
+  end
+
+  `FF(miss_cnt_q, miss_cnt_d, '0, clk_i, rst_ni)
+
+  axi_tagctrl_tag_store #(
+      .Cfg         (Cfg),
+      .ReplPolicy  (ReplPolicy),
+      .way_ind_t   (way_ind_t),
+      .store_req_t (store_req_t),
+      .store_res_t (store_res_t),
+      .PrintSramCfg(PrintSramCfg)
+  ) i_tag_store (
+      .clk_i,
+      .rst_ni,
+      .test_i,
+      .spm_lock_i  (spm_lock_i | flushed_i | mshr_ways),
+      .flushed_i,
+      .req_i       (store_req),
+      .valid_i     (store_req_valid),
+      .ready_o     (store_req_ready),
+      .res_o       (store_res),
+      .valid_o     (store_res_valid),
+      .ready_i     (store_res_ready),
+      .bist_res_o,
+      .bist_valid_o
+  );
+
+  // pragma translate_off
+`ifndef VERILATOR
+  initial begin : proc_check_params
+    id_width :
+    assert (AxiCfg.SlvPortIdWidth >= CntIdxWidth)
+    else $fatal(1, "The AXI ID has to be at least as wide as the miss counter index!");
+  end
+  onehot_out :
+  assert property (@(posedge clk_i) disable iff (!rst_ni) !(hit_valid_o && miss_valid_o))
+  else $fatal(1, "Descriptor is on the hit and the miss path at the same time!");
+`endif
+  // pragma translate_on
+endmodule
@@ -14,6 +14,64 @@ package axi_tagctrl_pkg;
   /// This is ASCII encoded after the semantic versioning: `vAA.BB.C`
   parameter logic [63:0] AxiTagCtrlVersion = 64'h7630_302E_3032_2E31;
   parameter logic [3:0] AxReqId = 4'b1011;
+  /// Offset of the tag controller registers on the configuration RegBus. Accesses below this
+  /// offset go to the `axi_llc` register file.
+  parameter logic [31:0] TagCtrlRegOffset = 32'h0000_0400;
+  /// Number of programmable address regions in (module.axi_tagctrl_regs).
+  parameter int unsigned NumAddrRegions = 32'd4;
+  /// Alignment of the address region bounds in byte.
+  ///
+  /// AXI bursts never cross a 4 KiB boundary, so every burst lies either completely inside or
+  /// completely outside of a region and its start address decides.
+  parameter int unsigned AddrRegionAlign = 32'd4096;
+  /// Number of tag cache way partitions in (module.axi_tagctrl_regs).
+  ///
+  /// Partition 0 is the default partition of all requests which match no other partition.
+  parameter int unsigned NumPartitions = 32'd4;
+  /// Partition index type.
+  typedef logic [cf_math_pkg::idx_width(NumPartitions)-1:0] part_idx_t;
+
+  /// Number of miss status holding registers of the tag cache, see (module.axi_tagctrl_hit_miss).
+  ///
+  /// Defines how many tag cache lines can be in flight between the lookup and the read / write
+  /// units at the same time.
+  parameter int unsigned TagcNumMshr = 32'd8;
+
+  /// Number of neighbouring blocks refilled on each side of the blocks a tag cache miss needs.
+  ///
+  /// The tag cache lines are sectored, every block has its own valid and dirty bit. A miss only
+  /// refills the blocks its descriptor accesses, plus this many blocks before and after them,
+  /// clipped to the cache line. See (module.axi_tagctrl_refill_unit).
+  parameter int unsigned TagcRefillNeighbours = 32'd0;
+
+  /// Number of tag words kept in the tag word buffer of each slave port, see
+  /// (module.axi_tagctrl_tag_buf).
+  ///
+  /// A read burst inside a single buffered tag word takes it from the buffer and does not access
+  /// the tag cache. `0` removes the buffers.
+  parameter int unsigned TagBufEntries = 32'd4;
+
+  /// Number of posted write bursts of a slave port which can wait for their responses, see
+  /// (module.axi_tagctrl_w).
+  ///
+  /// Reads of all slave ports which overlap one of them are held until it got its responses.
+  parameter int unsigned PostedWrDepth = 32'd4;
+
+  /// Index of the background flush unit at the tag cache descriptor arbiter, next to
+  /// `axi_llc_pkg::ConfigUnit`, `axi_llc_pkg::AwChanUnit` and `axi_llc_pkg::ArChanUnit`.
+  parameter int unsigned FlushUnit = 32'd3;
+
+  /// Replacement policy of the tag cache, see (module.axi_tagctrl_evict_box).
+  typedef enum logic [1:0] {
+    /// Pseudo random victim
+    ReplRandom = 2'd0,
+    /// Tree pseudo least recently used
+    ReplPlru   = 2'd1,
+    /// Static re-reference interval prediction
+    ReplSrrip  = 2'd2,
+    /// Bimodal re-reference interval prediction
+    ReplBrrip  = 2'd3
+  } repl_policy_e;
 
   /// Tag Controller configuration struct.
   /// Automatically set in (module.axi_llc_top).
@@ -43,4 +101,141 @@ package axi_tagctrl_pkg;
     axi_llc_pkg::llc_cfg_t tagc_cfg;
   } tagctrl_cfg_t;
 
+  /// Programmable address region.
+  ///
+  /// The region spans from `start_addr` (inclusive) to `end_addr` (exclusive), both aligned to
+  /// `AddrRegionAlign`. Regions marked as `untagged` never hold capabilities, accesses to them
+  /// bypass the tag cache.
+  typedef struct packed {
+    /// Start address of the region
+    logic [63:0] start_addr;
+    /// End address of the region
+    logic [63:0] end_addr;
+    /// The region does not hold capability tags
+    logic        untagged;
+    /// The region is enabled
+    logic        en;
+  } addr_region_t;
+
+  /// Tag cache way partition.
+  ///
+  /// A request belongs to the partition if its AXI ID lies in `[id_first, id_last]` and its AX
+  /// user bits selected by `user_mask` equal `user_value`. Lookups of all partitions can hit in
+  /// every way, misses only allocate in the ways set in `way_mask`. A zero mask allows all ways.
+  typedef struct packed {
+    /// First AXI ID of the partition
+    logic [31:0] id_first;
+    /// Last AXI ID of the partition
+    logic [31:0] id_last;
+    /// AX user bits which are compared
+    logic [31:0] user_mask;
+    /// Expected value of the compared AX user bits
+    logic [31:0] user_value;
+    /// Ways the partition allocates in
+    logic [63:0] way_mask;
+    /// The partition is enabled
+    logic        en;
+  } partition_t;
+
+  /// Background flush configuration, see (module.axi_tagctrl_flush_unit).
+  ///
+  /// The flush writes back dirty tag lines while the tag controller keeps serving requests.
+  /// The lines stay valid in the tag cache.
+  typedef struct packed {
+    /// Start address of the flushed data range (inclusive), used in range mode
+    logic [63:0] start_addr;
+    /// End address of the flushed data range (exclusive), used in range mode
+    logic [63:0] end_addr;
+    /// Only flush the tag lines covering `[start_addr, end_addr)`
+    logic        range;
+    /// Start the flush, set for a single cycle
+    logic        start;
+  } flush_cfg_t;
+
+  /// Posted write configuration, see (module.axi_tagctrl_w).
+  ///
+  /// In posted mode a write burst gets its B response once its W beats and its tag update are
+  /// accepted into the buffers of the tag controller. The B responses of memory and tag cache are
+  /// collected in the background, errors are reported through the register file.
+  typedef struct packed {
+    /// Send the B response of write bursts once they are buffered
+    logic en;
+    /// Raise the interrupt when a posted write fails
+    logic irq_en;
+  } posted_cfg_t;
+
+  /// Tag controller configuration registers, Registers -> HW.
+  /// Written through the register file (module.axi_tagctrl_regs).
+  typedef struct packed {
+    /// Programmable address regions
+    addr_region_t [NumAddrRegions-1:0] addr_region;
+    /// Tag cache way partitions
+    partition_t [NumPartitions-1:0] partition;
+    /// Background flush
+    flush_cfg_t flush;
+    /// Posted writes
+    posted_cfg_t posted;
+  } tagctrl_regs_q_t;
+
+  /// Tag controller status events, HW -> Registers.
+  typedef struct packed {
+    /// A tag lookup of the partition hit
+    logic [NumPartitions-1:0] part_hit;
+    /// A tag lookup of the partition missed
+    logic [NumPartitions-1:0] part_miss;
+    /// The background flush is running
+    logic                     flush_busy;
+    /// The background flush wrote back a dirty tag line
+    logic                     flush_line;
+    /// Number of error responses of posted writes in this cycle, from memory and the tag cache of
+    /// all slave ports
+    logic [7:0]               posted_errs;
+    /// Response of the failed posted write
+    axi_pkg::resp_t           posted_err_resp;
+  } tagctrl_regs_d_t;
+
+  /// Address of the beat following `addr` in an AXI burst.
+  ///
+  /// INCR bursts advance to the next aligned address, FIXED bursts keep the address and WRAP
+  /// bursts fold back onto the wrap boundary once the end of the wrapped region is reached.
+  function automatic axi_pkg::largest_addr_t next_beat_addr(axi_pkg::largest_addr_t addr,
+                                                           axi_pkg::size_t size,
+                                                           axi_pkg::len_t len,
+                                                           axi_pkg::burst_t burst);
+    axi_pkg::largest_addr_t next_addr, wrap_addr;
+    next_addr = axi_pkg::aligned_addr(addr + axi_pkg::num_bytes(size), size);
+    case (burst)
+      axi_pkg::BURST_FIXED: next_addr = addr;
+      axi_pkg::BURST_WRAP: begin
+        wrap_addr = axi_pkg::wrap_boundary(addr, size, len);
+        if (next_addr == wrap_addr + ((axi_pkg::largest_addr_t'(len) + 1) << size)) begin
+          next_addr = wrap_addr;
+        end
+      end
+      default:  /* BURST_INCR */;
+    endcase
+    return next_addr;
+  endfunction
+
+  /// Address of the first byte an AXI burst accesses.
+  ///
+  /// WRAP bursts start at their wrap boundary, all other bursts at their start address.
+  function automatic axi_pkg::largest_addr_t burst_first_addr(axi_pkg::largest_addr_t addr,
+                                                             axi_pkg::size_t size,
+                                                             axi_pkg::len_t len,
+                                                             axi_pkg::burst_t burst);
+    return (burst == axi_pkg::BURST_WRAP) ? axi_pkg::wrap_boundary(addr, size, len) :
+                                            axi_pkg::aligned_addr(addr, size);
+  endfunction
+
+  /// Address of the last byte an AXI burst accesses.
+  function automatic axi_pkg::largest_addr_t burst_last_addr(axi_pkg::largest_addr_t addr,
+                                                            axi_pkg::size_t size,
+                                                            axi_pkg::len_t len,
+                                                            axi_pkg::burst_t burst);
+    axi_pkg::largest_addr_t beats;
+    beats = (burst == axi_pkg::BURST_FIXED) ? 1 : axi_pkg::largest_addr_t'(len) + 1;
+    return burst_first_addr(addr, size, len, burst) + (beats << size) - 1;
+  endfunction
+
 endpackage
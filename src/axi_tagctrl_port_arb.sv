@@ -0,0 +1,109 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+/// Weighted round robin arbiter of the tag cache descriptors of the slave ports.
+///
+/// Each slave port of (module.axi_tagctrl_top) gets `Weights[port]` descriptors per arbitration
+/// round. Ports which used up their share are masked, as long as a port with credits left
+/// requests. A new round starts once no requesting port has credits left. Inside a round the
+/// ports are served round robin by `rr_arb_tree`, a granted descriptor stays selected until it is
+/// accepted.
+module axi_tagctrl_port_arb #(
+    /// Number of slave ports
+    parameter int unsigned NumPorts = 32'd1,
+    /// Descriptors of each port per arbitration round, in `[1, 255]`
+    parameter int unsigned Weights[NumPorts] = '{default: 32'd1},
+    /// Tag cache descriptor type
+    parameter type desc_t = logic
+) (
+    /// Clock, positive edge triggered
+    input  logic                  clk_i,
+    /// Asynchronous reset, active low
+    input  logic                  rst_ni,
+    /// Descriptors of the ports
+    input  desc_t [NumPorts-1:0]  desc_i,
+    /// Descriptor of the port is valid
+    input  logic  [NumPorts-1:0]  valid_i,
+    /// Descriptor of the port is accepted
+    output logic  [NumPorts-1:0]  ready_o,
+    /// Arbitrated descriptor
+    output desc_t                 desc_o,
+    /// Arbitrated descriptor is valid
+    output logic                  valid_o,
+    /// Arbitrated descriptor is accepted
+    input  logic                  ready_i
+);
+  `include "common_cells/registers.svh"
+
+  if (NumPorts == 32'd1) begin : gen_single_port
+    assign desc_o  = desc_i[0];
+    assign valid_o = valid_i[0];
+    assign ready_o = ready_i;
+  end else begin : gen_weighted_rr
+    typedef logic [7:0] credit_t;
+    typedef logic [cf_math_pkg::idx_width(NumPorts)-1:0] port_idx_t;
+
+    credit_t [NumPorts-1:0] credits_d, credits_q;
+    logic    [NumPorts-1:0] has_credit, arb_req;
+    logic                   new_round;
+    port_idx_t              arb_idx;
+
+    for (genvar i = 0; i < NumPorts; i++) begin : gen_credit
+      assign has_credit[i] = valid_i[i] & (credits_q[i] != '0);
+    end
+
+    // No requesting port has credits left, every port gets its full share again. The requests
+    // are not masked in this cycle, so that the round starts without a bubble.
+    assign new_round = ~|has_credit;
+    assign arb_req   = new_round ? valid_i : has_credit;
+
+    always_comb begin : proc_credits
+      credits_d = credits_q;
+      if (new_round) begin
+        for (int unsigned i = 0; i < NumPorts; i++) begin
+          credits_d[i] = credit_t'(Weights[i]);
+        end
+      end
+      if (valid_o && ready_i) begin
+        credits_d[arb_idx] = credits_d[arb_idx] - credit_t'(1);
+      end
+    end
+
+    `FF(credits_q, credits_d, '0, clk_i, rst_ni)
+
+    rr_arb_tree #(
+        .NumIn    (NumPorts),
+        .DataType (desc_t),
+        .AxiVldRdy(1'b1),
+        .LockIn   (1'b1)
+    ) i_port_arb_tree (
+        .clk_i  (clk_i),
+        .rst_ni (rst_ni),
+        .flush_i(1'b0),
+        .rr_i   ('0),
+        .req_i  (arb_req),
+        .gnt_o  (ready_o),
+        .data_i (desc_i),
+        .gnt_i  (ready_i),
+        .req_o  (valid_o),
+        .data_o (desc_o),
+        .idx_o  (arb_idx)
+    );
+  end
+
+  // pragma translate_off
+`ifndef VERILATOR
+  initial begin : proc_assert_weights
+    for (int unsigned i = 0; i < NumPorts; i++) begin
+      assert (Weights[i] inside {[32'd1 : 32'd255]})
+      else $fatal(1, $sformatf("Weight of slave port %0d has to be in [1, 255]!", i));
+    end
+  end
+`endif
+  // pragma translate_on
+
+endmodule
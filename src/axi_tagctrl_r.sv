@@ -7,7 +7,19 @@
 
 `include "common_cells/registers.svh"
 
-/// [TODO] Description here
+/// R channel unit of the tag controller.
+///
+/// Adds the tag bit of every R beat from memory as user bit. The tag words arrive as a stream
+/// from the tag cache, a burst spanning several tag cache lines gets them from consecutive tag
+/// cache descriptors. They are buffered ahead, so that a burst moving on to the next tag word
+/// does not wait for the tag cache.
+///
+/// A burst whose tag word hit in the tag word buffer (module.axi_tagctrl_tag_buf) carries it in
+/// its descriptor (`tag_hit`). Tag words of bursts with `tag_fill` are handed to the buffer when
+/// they arrive.
+///
+/// The R beats of atomics come with their tag from the (module.axi_tagctrl_w) unit. They are sent
+/// between the bursts of the descriptors, ahead of the next one.
 
 module axi_tagctrl_r #(
     /// Tag Controller configuration struct.This is passed down from
@@ -47,14 +59,27 @@ module axi_tagctrl_r #(
     /// R beat is valid.
     output logic r_chan_slv_valid_o,
     /// R beat is ready.
-    input logic r_chan_slv_ready_i
+    input logic r_chan_slv_ready_i,
+    /// The tag word of a burst with `tag_fill` arrived.
+    output logic tagbuf_fill_o,
+    /// Tag word index of the arrived tag word, relative to `DRAMMemBase`.
+    output logic [Cfg.AxiAddrWidth-1:0] tagbuf_fill_word_o,
+    /// Arrived tag word.
+    output logic [Cfg.AxiDataWidth-1:0] tagbuf_fill_data_o,
+    /// R beat of an atomic.
+    input r_chan_t atop_r_i,
+    /// R beat of an atomic is valid.
+    input logic atop_r_valid_i,
+    /// R beat of an atomic is ready.
+    output logic atop_r_ready_o
 );
   // Registers
   tagctrl_desc_t tagctrl_desc_d, tagctrl_desc_q;
   logic load_desc;
   enum logic [1:0] {
     IDLE,
-    SEND_R_CHANNEL
+    SEND_R_CHANNEL,
+    SEND_ATOP_R
   }
       state_d, state_q;
   // AXI tag cache channel signals
@@ -68,15 +93,33 @@ module axi_tagctrl_r #(
   logic mem_fifo_pop;  // pop data from FIFO if it gets transferred
   r_chan_t mem_fifo_data;  // gets assigned to the w channel
   r_chan_t mem_fifo_indata;
+  // Tag word FIFO control signals
+  logic tag_fifo_full;  // the FIFO is full
+  logic tag_fifo_empty;  // the FIFO is empty
+  logic tag_fifo_pop;  // the tag word is loaded
+  tagc_inp_t tag_fifo_data;  // next tag word
   // auxiliary signals
   // Tag index bit (indicates if we are reading from a valid capability or not)
   logic [$clog2(Cfg.AxiDataWidth)-1:0] tag_bit_ind;
+  // Address of the next beat, follows the burst type (FIXED, INCR or WRAP) of the descriptor
+  logic [Cfg.AxiAddrWidth-1:0] next_addr;
+  // The next beat is covered by another tag word
+  logic next_tag_word;
 
   // AXI Slave R port channel assignments
   // AXI Master R port channel assignments
   assign r_chan_ready_o = !mem_fifo_full;
   // Decode tag bit index based on the address
   assign tag_bit_ind = tagctrl_desc_q.a_x_addr[$clog2(Cfg.CapSize/8)+:$clog2(Cfg.AxiDataWidth)];
+  assign next_addr = axi_tagctrl_pkg::next_beat_addr(
+      tagctrl_desc_q.a_x_addr,
+      tagctrl_desc_q.a_x_size,
+      tagctrl_desc_q.a_x_len,
+      tagctrl_desc_q.a_x_burst
+  );
+  // only INCR bursts leave the tag word, WRAP bursts fold back inside of it
+  assign next_tag_word = (next_addr >> $clog2(Cfg.AxiDataWidth * Cfg.CapSize / 8)) !=
+      (tagctrl_desc_q.a_x_addr >> $clog2(Cfg.AxiDataWidth * Cfg.CapSize / 8));
 
   always_comb begin : r_chan_ctrl
     // registers default values
@@ -88,53 +131,79 @@ module axi_tagctrl_r #(
     tagc_inp_r_valid_d = tagc_inp_r_valid_q;
     load_tags_valid = 1'b0;
     mem_fifo_pop = 1'b0;
+    tag_fifo_pop = 1'b0;
+    tagbuf_fill_o = 1'b0;
+    tagbuf_fill_word_o = '0;
+    tagbuf_fill_data_o = tag_fifo_data.data;
     // logic for handshake signals
     tagctrl_desc_ready_o = 1'b0;
-    tagc_inp_r_ready_o = 1'b0;
     r_chan_slv_valid_o = 1'b0;
+    atop_r_ready_o = 1'b0;
     // output signals
     r_chan_slv_o = '0;
 
     case (state_q)
       IDLE: begin
-        load_new_desc();
-        get_tags();
+        if (atop_r_valid_i) begin
+          state_d = SEND_ATOP_R;
+        end else begin
+          load_new_desc();
+          // untagged bursts do not get a tag word from the tag cache
+          if (tagctrl_desc_valid_i && !tagctrl_desc_i.untagged) begin
+            get_tags(tagctrl_desc_i);
+          end
+        end
       end
       SEND_R_CHANNEL: begin
-        if (tagc_inp_r_valid_q && !mem_fifo_empty) begin
+        if ((tagc_inp_r_valid_q || tagctrl_desc_q.untagged) && !mem_fifo_empty) begin
           r_chan_slv_valid_o = 1'b1;
           mem_fifo_pop = r_chan_slv_ready_i;
           // update the address
-          tagctrl_desc_d.a_x_addr = axi_pkg::aligned_addr(
-            tagctrl_desc_q.a_x_addr + axi_pkg::num_bytes(
-              tagctrl_desc_q.a_x_size
-            ),
-            tagctrl_desc_q.a_x_size
-          );
+          tagctrl_desc_d.a_x_addr = next_addr;
           load_desc = r_chan_slv_ready_i;
           r_chan_slv_o = mem_fifo_data;
           // set id filled with the one from the descriptor
           r_chan_slv_o.id = tagctrl_desc_q.a_x_id;
-          // set user field with the tag bit
-          r_chan_slv_o.user = (tagc_inp_r_q.data >> tag_bit_ind) & 1;
+          // set user field with the tag bit, untagged regions never hold capabilities
+          r_chan_slv_o.user = tagctrl_desc_q.untagged ? '0 : (tagc_inp_r_q.data >> tag_bit_ind) & 1;
           // load more tags if needed
-          if ((tag_bit_ind == (Cfg.AxiDataWidth - 1) && tagctrl_desc_d.a_x_addr[0+:$clog2(
-                  Cfg.CapSize/8
-              )] == 0) && !mem_fifo_data.last && r_chan_slv_ready_i) begin
-            get_tags();
+          if (!tagctrl_desc_q.untagged && next_tag_word && !mem_fifo_data.last &&
+              r_chan_slv_ready_i) begin
+            get_tags(tagctrl_desc_q);
           end
           if (mem_fifo_data.last && r_chan_slv_ready_i) begin
-            load_new_desc();
-            get_tags();
+            if (atop_r_valid_i) begin
+              // the R beats of an atomic go first
+              state_d = SEND_ATOP_R;
+              drop_tags();
+            end else begin
+              load_new_desc();
+              if (tagctrl_desc_valid_i && !tagctrl_desc_i.untagged) begin
+                get_tags(tagctrl_desc_i);
+              end else begin
+                drop_tags();
+              end
+            end
           end
         end
-        if (!tagc_inp_r_valid_q) begin
-          get_tags();
+        if (!tagc_inp_r_valid_q && !tagctrl_desc_q.untagged) begin
+          get_tags(tagctrl_desc_q);
           mem_fifo_pop = 1'b0;
           r_chan_slv_valid_o = 1'b0;
           load_desc = 1'b0;
         end
       end
+      SEND_ATOP_R: begin
+        r_chan_slv_o = atop_r_i;
+        r_chan_slv_valid_o = atop_r_valid_i;
+        atop_r_ready_o = r_chan_slv_ready_i;
+        if (atop_r_valid_i && r_chan_slv_ready_i && atop_r_i.last) begin
+          load_new_desc();
+          if (tagctrl_desc_valid_i && !tagctrl_desc_i.untagged) begin
+            get_tags(tagctrl_desc_i);
+          end
+        end
+      end
       // Go to Idle
       default: begin
         state_d = IDLE;
@@ -163,20 +232,36 @@ module axi_tagctrl_r #(
     end
   endfunction : load_new_desc
 
-  // this function loads a new descriptor from the `axi_tagctrl_ax.sv` unit
-  function void get_tags();
-    tagc_inp_r_ready_o = 1'b1;
+  // this function loads the next tag word of the burst of `desc`
+  function void get_tags(tagctrl_desc_t desc);
     tagc_inp_r_valid_d = 1'b0;
     load_tags_valid = 1'b1;
-    // new descriptor at the input
-    if (tagc_inp_r_valid_i) begin
-      tagc_inp_r_d = tagc_inp_r_i;
+    if (desc.tag_hit) begin
+      // the tag word buffer had it
+      tagc_inp_r_d = '0;
+      tagc_inp_r_d.data = desc.tag_data;
       load_tags = 1'b1;
       tagc_inp_r_valid_d = 1'b1;
-      load_tags_valid = 1'b1;
+    end else begin
+      tag_fifo_pop = 1'b1;
+      // new tag word from the tag cache
+      if (!tag_fifo_empty) begin
+        tagc_inp_r_d = tag_fifo_data;
+        load_tags = 1'b1;
+        tagc_inp_r_valid_d = 1'b1;
+        tagbuf_fill_o = desc.tag_fill;
+        tagbuf_fill_word_o = (desc.a_x_addr - Cfg.DRAMMemBase) >>
+            $clog2(Cfg.tagc_cfg.BlockSize * (Cfg.CapSize / 8));
+      end
     end
   endfunction : get_tags
 
+  // this function releases the current tag word, the burst does not need it anymore
+  function void drop_tags();
+    tagc_inp_r_valid_d = 1'b0;
+    load_tags_valid = 1'b1;
+  endfunction : drop_tags
+
   // FIFO holds R beats from mem
   fifo_v3 #(
       .FALL_THROUGH(1'b0),               // FIFO is in fall-through mode
@@ -199,6 +284,27 @@ module axi_tagctrl_r #(
       .pop_i     (mem_fifo_pop)       // pop head from queue
   );
 
+  // FIFO holds the tag words from the tag cache
+  assign tagc_inp_r_ready_o = !tag_fifo_full;
+
+  fifo_v3 #(
+      .FALL_THROUGH(1'b1),
+      .DEPTH       (Cfg.TagRFifoDepth),
+      .dtype       (tagc_inp_t)
+  ) i_r_tag_fifo (
+      .clk_i     (clk_i),
+      .rst_ni    (rst_ni),
+      .flush_i   ('0),
+      .testmode_i('0),
+      .full_o    (tag_fifo_full),
+      .empty_o   (tag_fifo_empty),
+      .usage_o   (  /* not used */),
+      .data_i    (tagc_inp_r_i),
+      .push_i    (tagc_inp_r_valid_i && !tag_fifo_full),
+      .data_o    (tag_fifo_data),
+      .pop_i     (tag_fifo_pop && !tag_fifo_empty)
+  );
+
   // Registers Flip Flops
   `FFLARN(state_q, state_d, '1, IDLE, clk_i, rst_ni)
   `FFLARN(tagctrl_desc_q, tagctrl_desc_d, load_desc, '0, clk_i, rst_ni)
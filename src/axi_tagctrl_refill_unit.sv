@@ -0,0 +1,225 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+`include "common_cells/registers.svh"
+
+/// Refill unit of the sectored tag cache.
+///
+/// Refills only the blocks of a cache line in `desc_i.refill_blk` instead of the whole line. One
+/// AR burst is made per descriptor, spanning from the first to the last block to refill. R beats of
+/// blocks in the span which are not refilled are valid in the cache and possibly dirty, they are
+/// dropped. The ARs are made ahead of the R beats, up to `RefillDepth` refills are outstanding.
+/// All ARs use the same ID, the R bursts return in order.
+///
+/// Descriptors without `refill` pass through, behind the refills in front of them.
+module axi_tagctrl_refill_unit #(
+    /// Static LLC configuration struct
+    parameter axi_llc_pkg::llc_cfg_t Cfg = axi_llc_pkg::llc_cfg_t'{default: '0},
+    /// AXI parameter configuration
+    parameter axi_llc_pkg::llc_axi_cfg_t AxiCfg = axi_llc_pkg::llc_axi_cfg_t'{default: '0},
+    /// Descriptor type
+    parameter type desc_t = logic,
+    /// Data way request payload type
+    parameter type way_inp_t = logic,
+    /// AXI AR channel payload type
+    parameter type ar_chan_t = logic,
+    /// AXI R channel payload type
+    parameter type r_chan_t = logic
+) (
+    /// Clock, positive edge triggered
+    input  logic     clk_i,
+    /// Asynchronous reset, active low
+    input  logic     rst_ni,
+    /// Testmode enable
+    input  logic     test_i,
+    /// Input descriptor payload
+    input  desc_t    desc_i,
+    /// Input descriptor is valid
+    input  logic     desc_valid_i,
+    /// Unit is ready to accept a new descriptor
+    output logic     desc_ready_o,
+    /// Output descriptor payload
+    output desc_t    desc_o,
+    /// Output descriptor is valid
+    output logic     desc_valid_o,
+    /// Next unit is ready to accept the output descriptor
+    input  logic     desc_ready_i,
+    /// Data way request payload, writes the refilled blocks
+    output way_inp_t way_inp_o,
+    /// Data way request is valid
+    output logic     way_inp_valid_o,
+    /// Data way is ready to accept a request
+    input  logic     way_inp_ready_i,
+    /// AXI AR channel payload
+    output ar_chan_t ar_chan_mst_o,
+    /// AXI AR channel is valid
+    output logic     ar_chan_valid_o,
+    /// AXI AR channel is ready
+    input  logic     ar_chan_ready_i,
+    /// AXI R channel payload
+    input  r_chan_t  r_chan_mst_i,
+    /// AXI R channel is valid
+    input  logic     r_chan_valid_i,
+    /// AXI R channel is ready
+    output logic     r_chan_ready_o
+);
+
+  /// Number of descriptors between the AR and R side of the unit.
+  localparam int unsigned RefillDepth = 32'd4;
+
+  localparam int unsigned IndexBase = Cfg.ByteOffsetLength + Cfg.BlockOffsetLength;
+
+  typedef logic [Cfg.BlockOffsetLength-1:0] offset_t;
+  typedef logic [Cfg.NumBlocks-1:0] blk_t;
+
+  // Descriptors in the order of their ARs
+  desc_t fifo_desc;
+  logic fifo_full, fifo_empty, fifo_push, fifo_pop;
+  // R beat of the head descriptor
+  offset_t beat_d, beat_q, blk_offset;
+  logic load_beat;
+  // All R beats of the head descriptor are written
+  logic done_d, done_q, load_done;
+
+  function automatic offset_t first_blk(blk_t blk);
+    offset_t first = '0;
+    for (int i = Cfg.NumBlocks - 1; i >= 0; i--) begin
+      if (blk[i]) first = offset_t'(i);
+    end
+    return first;
+  endfunction
+
+  function automatic offset_t last_blk(blk_t blk);
+    offset_t last = '0;
+    for (int i = 0; i < Cfg.NumBlocks; i++) begin
+      if (blk[i]) last = offset_t'(i);
+    end
+    return last;
+  endfunction
+
+  // AR of the span of blocks to refill
+  always_comb begin : proc_ar_chan
+    ar_chan_mst_o       = '0;
+    ar_chan_mst_o.addr  = desc_i.a_x_addr;
+    ar_chan_mst_o.addr[IndexBase-1:0] = {
+      first_blk(desc_i.refill_blk), {Cfg.ByteOffsetLength{1'b0}}
+    };
+    ar_chan_mst_o.len   = axi_pkg::len_t'(last_blk(desc_i.refill_blk) -
+                                          first_blk(desc_i.refill_blk));
+    ar_chan_mst_o.size  = axi_pkg::size_t'($clog2(Cfg.BlockSize / 32'd8));
+    ar_chan_mst_o.burst = axi_pkg::BURST_INCR;
+  end
+
+  // A descriptor is queued once its AR is sent. The FIFO only fills with the AR valid pending.
+  always_comb begin : proc_desc_in
+    ar_chan_valid_o = 1'b0;
+    desc_ready_o    = 1'b0;
+    fifo_push       = 1'b0;
+    if (!fifo_full) begin
+      if (desc_valid_i && desc_i.refill) begin
+        ar_chan_valid_o = 1'b1;
+        desc_ready_o    = ar_chan_ready_i;
+        fifo_push       = ar_chan_ready_i;
+      end else begin
+        desc_ready_o = 1'b1;
+        fifo_push    = desc_valid_i;
+      end
+    end
+  end
+
+  fifo_v3 #(
+      .FALL_THROUGH(1'b0),
+      .DEPTH       (RefillDepth),
+      .dtype       (desc_t)
+  ) i_refill_fifo (
+      .clk_i,
+      .rst_ni,
+      .flush_i   (1'b0),
+      .testmode_i(test_i),
+      .full_o    (fifo_full),
+      .empty_o   (fifo_empty),
+      .usage_o   (  /*not used*/),
+      .data_i    (desc_i),
+      .push_i    (fifo_push),
+      .data_o    (fifo_desc),
+      .pop_i     (fifo_pop)
+  );
+
+  assign desc_o     = fifo_desc;
+  assign blk_offset = first_blk(fifo_desc.refill_blk) + beat_q;
+
+  assign way_inp_o = way_inp_t'{
+      cache_unit: axi_llc_pkg::RefilUnit,
+      way_ind:    fifo_desc.way_ind,
+      line_addr:  fifo_desc.a_x_addr[IndexBase+:Cfg.IndexLength],
+      blk_offset: blk_offset,
+      we:         1'b1,
+      data:       r_chan_mst_i.data,
+      strb:       '1,
+      bit_en:     '1,
+      default:    '0
+  };
+
+  // R beats towards the ways, the descriptor is sent along with the last one
+  always_comb begin : proc_refill
+    beat_d          = beat_q;
+    load_beat       = 1'b0;
+    done_d          = done_q;
+    load_done       = 1'b0;
+    r_chan_ready_o  = 1'b0;
+    way_inp_valid_o = 1'b0;
+    desc_valid_o    = 1'b0;
+    fifo_pop        = 1'b0;
+
+    if (!fifo_empty) begin
+      if (fifo_desc.refill && !done_q) begin
+        if (fifo_desc.refill_blk[blk_offset]) begin
+          way_inp_valid_o = r_chan_valid_i;
+          r_chan_ready_o  = way_inp_ready_i;
+        end else begin
+          // the block is valid in the cache, do not overwrite it
+          r_chan_ready_o = 1'b1;
+        end
+        if (r_chan_valid_i && r_chan_ready_o) begin
+          beat_d    = beat_q + offset_t'(1);
+          load_beat = 1'b1;
+          if (r_chan_mst_i.last) begin
+            desc_valid_o = 1'b1;
+            if (desc_ready_i) begin
+              fifo_pop = 1'b1;
+              beat_d   = '0;
+            end else begin
+              done_d    = 1'b1;
+              load_done = 1'b1;
+            end
+          end
+        end
+      end else begin
+        desc_valid_o = 1'b1;
+        if (desc_ready_i) begin
+          fifo_pop  = 1'b1;
+          beat_d    = '0;
+          load_beat = 1'b1;
+          done_d    = 1'b0;
+          load_done = 1'b1;
+        end
+      end
+    end
+  end
+
+  `FFLARN(beat_q, beat_d, load_beat, '0, clk_i, rst_ni)
+  `FFLARN(done_q, done_d, load_done, 1'b0, clk_i, rst_ni)
+
+  // pragma translate_off
+`ifndef VERILATOR
+  refill_blk: assert property (@(posedge clk_i) disable iff (!rst_ni)
+      (desc_valid_i && desc_i.refill) |-> (desc_i.refill_blk != '0))
+  else $fatal(1, "A refilling descriptor has to refill at least one block!");
+`endif
+  // pragma translate_on
+
+endmodule
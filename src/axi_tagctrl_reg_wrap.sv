@@ -19,8 +19,8 @@
 /// register.
 ///
 /// AXI ports: The FULL AXI ports, have different ID widths. The master ports ID is
-///            one bit wider than the slave port. The reason is the `axi_mux` which
-///            controls the AXI bypass.
+///            `$clog2(NumSlvPorts + 1)` bits wider than the slave ports. The reason is the
+///            `axi_mux` which merges the slave ports and the tag cache towards memory.
 ///
 /// # AXI4+ATOP Last Level Cache (LLC)
 ///
@@ -117,7 +117,9 @@
 /// | `way_ind`   | `logic`            | The way indicator. Is a vector of width equal of the set-associativity. Decodes the index of the cache set where the descriptor should make an access.                                                                                                                                                      |
 /// | `evict`     | `logic`            | The eviction flag. The descriptor missed and the line at the position was determined dirty by the detection. The evict unit will write back the dirty cache-line to the main memory.                                                                                                                        |
 /// | `evict_tag` | `logic`            | The eviction tag. As the field `a_x_addr` has the new tag in it, it is used to send back the right address to the main memory during eviction.                                                                                                                                                              |
+/// | `evict_blk` | `logic`            | The dirty blocks of the evicted line. Only these blocks are written back, the AW burst spans from the first to the last of them.                                                                                                                                                                            |
 /// | `refill`    | `logic`            | The refill flag. The descriptor will trigger a read transaction to the main memory, refilling the cache-line.                                                                                                                                                                                               |
+/// | `refill_blk`| `logic`            | The blocks of the line to refill. The cache lines are sectored, only the blocks which are accessed (and `TagcRefillNeighbours` around them) are refilled.                                                                                                                                                   |
 /// | `flush`     | `logic`            | The flush flag. This only gets set when a way should be flushed. It gets only set by descriptors coming from the configuration module.
 module axi_tagctrl_reg_wrap #(
     /// DRAM memory Base
@@ -163,8 +165,16 @@ module axi_tagctrl_reg_wrap #(
     /// Note on restrictions:
     /// The same restriction as of parameter `NumLines` applies.
     parameter int unsigned NumBlocks        = 32'd0,
-    /// AXI4+ATOP ID field width of the slave port.
-    /// The ID field width of the master port is this parameter + 1.
+    /// Replacement policy of the tag cache, see (module.axi_tagctrl_evict_box).
+    parameter axi_tagctrl_pkg::repl_policy_e ReplPolicy = axi_tagctrl_pkg::ReplRandom,
+    /// Number of AXI4+ATOP slave ports. Every port has its own AX, R and W units, all of them
+    /// share the tag cache and the master port.
+    parameter int unsigned NumSlvPorts      = 32'd1,
+    /// Tag cache descriptors of each slave port per arbitration round, see
+    /// (module.axi_tagctrl_port_arb).
+    parameter int unsigned SlvPortWeights[NumSlvPorts] = '{default: 32'd1},
+    /// AXI4+ATOP ID field width of the slave ports.
+    /// The ID field width of the master port is this parameter + `$clog2(NumSlvPorts + 1)`.
     parameter int unsigned AxiIdWidth       = 32'd0,
     /// AXI4+ATOP address field width of both the slave and master port.
     parameter int unsigned AxiAddrWidth     = 32'd0,
@@ -206,10 +216,10 @@ module axi_tagctrl_reg_wrap #(
     input logic rst_ni,
     /// Test mode activate, active high.
     input logic test_i,
-    /// AXI4+ATOP slave port request, CPU side
-    input slv_req_t slv_req_i,
-    /// AXI4+ATOP slave port response, CPU side
-    output slv_resp_t slv_resp_o,
+    /// AXI4+ATOP slave port requests, CPU side
+    input slv_req_t [NumSlvPorts-1:0] slv_req_i,
+    /// AXI4+ATOP slave port responses, CPU side
+    output slv_resp_t [NumSlvPorts-1:0] slv_resp_o,
     /// AXI4+ATOP master port request, memory side
     output mst_req_t mst_req_o,
     /// AXI4+ATOP master port response, memory side
@@ -221,7 +231,9 @@ module axi_tagctrl_reg_wrap #(
     /// Start of address region mapped to cache
     input axi_addr_t cached_start_addr_i,
     /// End of address region mapped to cache
-    input axi_addr_t cached_end_addr_i
+    input axi_addr_t cached_end_addr_i,
+    /// Interrupt, a posted write failed, see register `PostedStatus` of (module.axi_tagctrl_regs)
+    output logic irq_o
 );
 
   // Define 64-bit register types for the AXI_LLC toplevel
@@ -239,6 +251,26 @@ module axi_tagctrl_reg_wrap #(
   `AXI_LLC_ASSIGN_REGS_Q_FROM_REGBUS(config_regs_q, config_reg2hw)
   `AXI_LLC_ASSIGN_REGBUS_FROM_REGS_D(config_hw2reg, config_regs_d)
 
+  // Tag controller specific registers
+  axi_tagctrl_pkg::tagctrl_regs_q_t tagctrl_regs_q;
+  axi_tagctrl_pkg::tagctrl_regs_d_t tagctrl_regs_d;
+
+  // Split the RegBus between the `axi_llc` register file and the tag controller registers
+  reg_req_t llc_conf_req, tagctrl_conf_req;
+  reg_resp_t llc_conf_resp, tagctrl_conf_resp;
+  logic tagctrl_conf_sel;
+
+  assign tagctrl_conf_sel = (conf_req_i.addr >= axi_tagctrl_pkg::TagCtrlRegOffset);
+
+  always_comb begin : proc_conf_demux
+    llc_conf_req           = conf_req_i;
+    llc_conf_req.valid     = conf_req_i.valid & ~tagctrl_conf_sel;
+    tagctrl_conf_req       = conf_req_i;
+    tagctrl_conf_req.valid = conf_req_i.valid & tagctrl_conf_sel;
+    tagctrl_conf_req.addr  = conf_req_i.addr - axi_tagctrl_pkg::TagCtrlRegOffset;
+    conf_resp_o            = tagctrl_conf_sel ? tagctrl_conf_resp : llc_conf_resp;
+  end
+
   // Generated 32-bit RegBus register file
   axi_llc_reg_top #(
       .reg_req_t(reg_req_t),
@@ -246,8 +278,8 @@ module axi_tagctrl_reg_wrap #(
   ) i_llc_config_regfile (
       .clk_i,
       .rst_ni,
-      .reg_req_i(conf_req_i),
-      .reg_rsp_o(conf_resp_o),
+      .reg_req_i(llc_conf_req),
+      .reg_rsp_o(llc_conf_resp),
 
       // To HW
       .reg2hw(config_reg2hw),  // Write
@@ -257,6 +289,20 @@ module axi_tagctrl_reg_wrap #(
       .devmode_i(1'b1)  // If 1, explicit error return for unmapped register access
   );
 
+  // 32-bit RegBus register file of the tag controller
+  axi_tagctrl_regs #(
+      .reg_req_t (reg_req_t),
+      .reg_resp_t(reg_resp_t)
+  ) i_tagctrl_regfile (
+      .clk_i,
+      .rst_ni,
+      .reg_req_i (tagctrl_conf_req),
+      .reg_resp_o(tagctrl_conf_resp),
+      .regs_o    (tagctrl_regs_q),
+      .regs_i    (tagctrl_regs_d),
+      .irq_o
+  );
+
   // Registerfile agnostic axi_llc toplevel - configured for 64-bit internal registers
   axi_tagctrl_top #(
       .CapSize         (CapSize),
@@ -265,6 +311,9 @@ module axi_tagctrl_reg_wrap #(
       .SetAssociativity(SetAssociativity),
       .NumLines        (NumLines),
       .NumBlocks       (NumBlocks),
+      .ReplPolicy      (ReplPolicy),
+      .NumSlvPorts     (NumSlvPorts),
+      .SlvPortWeights  (SlvPortWeights),
       .AxiIdWidth      (AxiIdWidth),
       .AxiAddrWidth    (AxiAddrWidth),
       .AxiDataWidth    (AxiDataWidth),
@@ -290,6 +339,9 @@ module axi_tagctrl_reg_wrap #(
       .conf_regs_i(config_regs_q),
       .conf_regs_o(config_regs_d),
 
+      .tagctrl_regs_i(tagctrl_regs_q),
+      .tagctrl_regs_o(tagctrl_regs_d),
+
       .cached_start_addr_i,
       .cached_end_addr_i
   );
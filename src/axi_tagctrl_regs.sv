@@ -0,0 +1,424 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+/// # Tag controller register file
+///
+/// 32-bit RegBus register file holding the configuration which is specific to the tag
+/// controller. It is placed on the configuration port at `axi_tagctrl_pkg::TagCtrlRegOffset`,
+/// next to the `axi_llc` register file. The addresses below are relative to this offset.
+///
+/// ## Register Map
+///
+/// | Offset                | Name            | read/write | Description                            |
+/// |:---------------------:|:---------------:|:----------:|:--------------------------------------:|
+/// | `0x000 + 0x20 * i`    | `RegionStartLo` | read-write | Start address of region `i`, `[31:0]`  |
+/// | `0x004 + 0x20 * i`    | `RegionStartHi` | read-write | Start address of region `i`, `[63:32]` |
+/// | `0x008 + 0x20 * i`    | `RegionEndLo`   | read-write | End address of region `i`, `[31:0]`    |
+/// | `0x00C + 0x20 * i`    | `RegionEndHi`   | read-write | End address of region `i`, `[63:32]`  |
+/// | `0x010 + 0x20 * i`    | `RegionCfg`     | read-write | [Region Configuration](###RegionCfg)   |
+/// | `0x100 + 0x20 * p`    | `PartIdFirst`   | read-write | First AXI ID of partition `p`          |
+/// | `0x104 + 0x20 * p`    | `PartIdLast`    | read-write | Last AXI ID of partition `p`           |
+/// | `0x108 + 0x20 * p`    | `PartUserMask`  | read-write | AX user bits compared for partition `p`|
+/// | `0x10C + 0x20 * p`    | `PartUserValue` | read-write | AX user value of partition `p`         |
+/// | `0x110 + 0x20 * p`    | `PartWayMaskLo` | read-write | Allocation ways of partition `p`, `[31:0]`  |
+/// | `0x114 + 0x20 * p`    | `PartWayMaskHi` | read-write | Allocation ways of partition `p`, `[63:32]` |
+/// | `0x118 + 0x20 * p`    | `PartCfg`       | read-write | Bit `[0]`: partition `p` enable        |
+/// | `0x200 + 0x10 * p`    | `PartHitLo`     | write-clear| Tag lookup hits of partition `p`, `[31:0]`    |
+/// | `0x204 + 0x10 * p`    | `PartHitHi`     | write-clear| Tag lookup hits of partition `p`, `[63:32]`   |
+/// | `0x208 + 0x10 * p`    | `PartMissLo`    | write-clear| Tag lookup misses of partition `p`, `[31:0]`  |
+/// | `0x20C + 0x10 * p`    | `PartMissHi`    | write-clear| Tag lookup misses of partition `p`, `[63:32]` |
+/// | `0x300`               | `FlushCtrl`     | read-write | [Background Flush Control](###FlushCtrl)   |
+/// | `0x304`               | `FlushStatus`   | read-only  | Bit `[0]`: background flush is busy    |
+/// | `0x308`               | `FlushStartLo`  | read-write | Start address of the flush range, `[31:0]`  |
+/// | `0x30C`               | `FlushStartHi`  | read-write | Start address of the flush range, `[63:32]` |
+/// | `0x310`               | `FlushEndLo`    | read-write | End address of the flush range, `[31:0]`    |
+/// | `0x314`               | `FlushEndHi`    | read-write | End address of the flush range, `[63:32]`   |
+/// | `0x318`               | `FlushLines`    | write-clear| Dirty tag lines written back by background flushes |
+/// | `0x400`               | `PostedCtrl`    | read-write | [Posted Write Control](###PostedCtrl)  |
+/// | `0x404`               | `PostedStatus`  | read-write | [Posted Write Status](###PostedStatus) |
+/// | `0x408`               | `PostedErrors`  | write-clear| Error responses of posted writes, memory and tag cache |
+///
+/// The region bounds are aligned to `axi_tagctrl_pkg::AddrRegionAlign`, the address bits below
+/// are hardwired to zero. There are `axi_tagctrl_pkg::NumAddrRegions` address regions and
+/// `axi_tagctrl_pkg::NumPartitions` partitions. Accesses to unmapped offsets return an error.
+///
+/// ### RegionCfg
+///
+/// Register Bit Map:
+/// | Bits     | Reset Value | Function                                        |
+/// |:--------:|:-----------:|:-----------------------------------------------:|
+/// | `[0]`    | `1'b0`      | Region enable                                   |
+/// | `[1]`    | `1'b0`      | Region is untagged, bypasses the tag cache      |
+/// | `[31:2]` | `'0`        | Reserved                                        |
+///
+/// ### Partitions
+///
+/// Partition 0 is the default partition, its ID and user fields are ignored. A request belongs
+/// to the enabled partition with the highest index whose ID range and user value match.
+/// The hit and miss counters are cleared by writing to either of their two words.
+///
+/// ### FlushCtrl
+///
+/// Register Bit Map:
+/// | Bits     | Reset Value | Function                                                   |
+/// |:--------:|:-----------:|:----------------------------------------------------------:|
+/// | `[0]`    | `1'b0`      | Write `1` to start a background flush, reads as `0`         |
+/// | `[1]`    | `1'b0`      | Only flush the tag lines of `[FlushStart, FlushEnd)`        |
+/// | `[31:2]` | `'0`        | Reserved                                                   |
+///
+/// A background flush writes back the dirty tag lines without isolating the slave port, see
+/// (module.axi_tagctrl_flush_unit). A start while `FlushStatus` is busy is ignored.
+///
+/// ### PostedCtrl
+///
+/// Register Bit Map:
+/// | Bits     | Reset Value | Function                                                   |
+/// |:--------:|:-----------:|:----------------------------------------------------------:|
+/// | `[0]`    | `1'b0`      | Posted writes, B is sent once a write burst is buffered    |
+/// | `[1]`    | `1'b0`      | Raise `irq_o` while `PostedStatus` has an error pending     |
+/// | `[31:2]` | `'0`        | Reserved                                                   |
+///
+/// ### PostedStatus
+///
+/// Register Bit Map:
+/// | Bits     | Reset Value | Function                                                   |
+/// |:--------:|:-----------:|:----------------------------------------------------------:|
+/// | `[0]`    | `1'b0`      | A posted write failed, write `1` to clear                  |
+/// | `[2:1]`  | `2'b0`      | AXI response of the first failed posted write              |
+/// | `[31:3]` | `'0`        | Reserved                                                   |
+///
+/// The response of a failed posted write was already acknowledged with `OKAY` on the slave port,
+/// see (module.axi_tagctrl_w).
+module axi_tagctrl_regs #(
+    /// Configuration RegBus interface request type
+    parameter type reg_req_t  = logic,
+    /// Configuration RegBus interface response type
+    parameter type reg_resp_t = logic
+) (
+    /// Rising-edge clock
+    input  logic                            clk_i,
+    /// Asynchronous reset, active low
+    input  logic                            rst_ni,
+    /// Configuration RegBus interface - request
+    input  reg_req_t                        reg_req_i,
+    /// Configuration RegBus interface - response
+    output reg_resp_t                       reg_resp_o,
+    /// Configuration registers Reg -> HW
+    output axi_tagctrl_pkg::tagctrl_regs_q_t regs_o,
+    /// Status events HW -> Reg
+    input  axi_tagctrl_pkg::tagctrl_regs_d_t regs_i,
+    /// Interrupt, a posted write failed
+    output logic                            irq_o
+);
+  // register macros from `common_cells`
+  `include "common_cells/registers.svh"
+
+  localparam int unsigned NumRegions = axi_tagctrl_pkg::NumAddrRegions;
+  localparam int unsigned NumParts = axi_tagctrl_pkg::NumPartitions;
+  // Base offsets and address space occupied by one entry of each register group
+  localparam int unsigned RegionBase = 32'h000;
+  localparam int unsigned RegionStride = 32'h20;
+  localparam int unsigned PartBase = 32'h100;
+  localparam int unsigned PartStride = 32'h20;
+  localparam int unsigned CntBase = 32'h200;
+  localparam int unsigned CntStride = 32'h10;
+  localparam int unsigned FlushBase = 32'h300;
+  localparam int unsigned PostedBase = 32'h400;
+
+  typedef logic [31:0] word_t;
+  // Address bits below the region alignment, hardwired to zero
+  localparam word_t RegionAlignMask = word_t'(axi_tagctrl_pkg::AddrRegionAlign - 1);
+
+  typedef logic [63:0] cnt_t;
+
+  axi_tagctrl_pkg::tagctrl_regs_q_t regs_d, regs_q;
+  logic load_regs;
+  // Per partition tag lookup counters
+  cnt_t [NumParts-1:0] hit_cnt_d, hit_cnt_q, miss_cnt_d, miss_cnt_q;
+  logic load_cnt;
+  // Tag lines written back by the background flush
+  word_t flush_cnt_d, flush_cnt_q;
+  // Failed posted writes, the first response is kept until the error is cleared
+  logic posted_err_d, posted_err_q;
+  axi_pkg::resp_t posted_resp_d, posted_resp_q;
+  word_t posted_cnt_d, posted_cnt_q;
+
+  `FFLARN(regs_q, regs_d, load_regs, '0, clk_i, rst_ni)
+  `FFLARN(hit_cnt_q, hit_cnt_d, load_cnt, '0, clk_i, rst_ni)
+  `FFLARN(miss_cnt_q, miss_cnt_d, load_cnt, '0, clk_i, rst_ni)
+  `FF(flush_cnt_q, flush_cnt_d, '0, clk_i, rst_ni)
+  `FF(posted_err_q, posted_err_d, 1'b0, clk_i, rst_ni)
+  `FF(posted_resp_q, posted_resp_d, axi_pkg::RESP_OKAY, clk_i, rst_ni)
+  `FF(posted_cnt_q, posted_cnt_d, '0, clk_i, rst_ni)
+
+  assign load_regs = (regs_d != regs_q);
+  assign load_cnt  = (hit_cnt_d != hit_cnt_q) | (miss_cnt_d != miss_cnt_q);
+  assign regs_o    = regs_q;
+  assign irq_o     = regs_q.posted.irq_en & posted_err_q;
+
+  // Apply the byte strobes of a RegBus write onto a register word.
+  function automatic word_t strb_word(word_t old_word, word_t wdata, logic [3:0] wstrb);
+    for (int unsigned i = 0; i < 4; i++) begin
+      if (wstrb[i]) begin
+        old_word[8*i+:8] = wdata[8*i+:8];
+      end
+    end
+    return old_word;
+  endfunction
+
+  always_comb begin : proc_reg_access
+    automatic int unsigned idx;
+    automatic int unsigned offset;
+    // Default assignments
+    regs_d           = regs_q;
+    reg_resp_o       = '0;
+    reg_resp_o.ready = 1'b1;
+    // The flush start is a pulse
+    regs_d.flush.start = 1'b0;
+    flush_cnt_d        = flush_cnt_q + word_t'(regs_i.flush_line);
+    posted_cnt_d       = posted_cnt_q + word_t'(regs_i.posted_errs);
+    posted_err_d       = posted_err_q | (regs_i.posted_errs != '0);
+    posted_resp_d      = posted_err_q ? posted_resp_q : regs_i.posted_err_resp;
+    // Counters count the events of this cycle, a write clears them afterwards
+    for (int unsigned i = 0; i < NumParts; i++) begin
+      hit_cnt_d[i]  = hit_cnt_q[i] + cnt_t'(regs_i.part_hit[i]);
+      miss_cnt_d[i] = miss_cnt_q[i] + cnt_t'(regs_i.part_miss[i]);
+    end
+
+    if (reg_req_i.valid) begin
+      if (reg_req_i.addr < PartBase) begin
+        // Address regions
+        idx    = (reg_req_i.addr - RegionBase) / RegionStride;
+        offset = (reg_req_i.addr - RegionBase) % RegionStride;
+        if (idx < NumRegions) begin
+          unique case (offset)
+            32'h00: begin
+              reg_resp_o.rdata = regs_q.addr_region[idx].start_addr[31:0];
+              if (reg_req_i.write) begin
+                regs_d.addr_region[idx].start_addr[31:0] =
+                    strb_word(regs_q.addr_region[idx].start_addr[31:0], reg_req_i.wdata,
+                              reg_req_i.wstrb) & ~RegionAlignMask;
+              end
+            end
+            32'h04: begin
+              reg_resp_o.rdata = regs_q.addr_region[idx].start_addr[63:32];
+              if (reg_req_i.write) begin
+                regs_d.addr_region[idx].start_addr[63:32] =
+                    strb_word(regs_q.addr_region[idx].start_addr[63:32], reg_req_i.wdata,
+                              reg_req_i.wstrb);
+              end
+            end
+            32'h08: begin
+              reg_resp_o.rdata = regs_q.addr_region[idx].end_addr[31:0];
+              if (reg_req_i.write) begin
+                regs_d.addr_region[idx].end_addr[31:0] =
+                    strb_word(regs_q.addr_region[idx].end_addr[31:0], reg_req_i.wdata,
+                              reg_req_i.wstrb) & ~RegionAlignMask;
+              end
+            end
+            32'h0C: begin
+              reg_resp_o.rdata = regs_q.addr_region[idx].end_addr[63:32];
+              if (reg_req_i.write) begin
+                regs_d.addr_region[idx].end_addr[63:32] =
+                    strb_word(regs_q.addr_region[idx].end_addr[63:32], reg_req_i.wdata,
+                              reg_req_i.wstrb);
+              end
+            end
+            32'h10: begin
+              reg_resp_o.rdata = {30'b0, regs_q.addr_region[idx].untagged,
+                                  regs_q.addr_region[idx].en};
+              if (reg_req_i.write && reg_req_i.wstrb[0]) begin
+                regs_d.addr_region[idx].en       = reg_req_i.wdata[0];
+                regs_d.addr_region[idx].untagged = reg_req_i.wdata[1];
+              end
+            end
+            default: reg_resp_o.error = 1'b1;
+          endcase
+        end else begin
+          reg_resp_o.error = 1'b1;
+        end
+      end else if (reg_req_i.addr < CntBase) begin
+        // Way partitions
+        idx    = (reg_req_i.addr - PartBase) / PartStride;
+        offset = (reg_req_i.addr - PartBase) % PartStride;
+        if (idx < NumParts) begin
+          unique case (offset)
+            32'h00: begin
+              reg_resp_o.rdata = regs_q.partition[idx].id_first;
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].id_first =
+                    strb_word(regs_q.partition[idx].id_first, reg_req_i.wdata, reg_req_i.wstrb);
+              end
+            end
+            32'h04: begin
+              reg_resp_o.rdata = regs_q.partition[idx].id_last;
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].id_last =
+                    strb_word(regs_q.partition[idx].id_last, reg_req_i.wdata, reg_req_i.wstrb);
+              end
+            end
+            32'h08: begin
+              reg_resp_o.rdata = regs_q.partition[idx].user_mask;
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].user_mask =
+                    strb_word(regs_q.partition[idx].user_mask, reg_req_i.wdata, reg_req_i.wstrb);
+              end
+            end
+            32'h0C: begin
+              reg_resp_o.rdata = regs_q.partition[idx].user_value;
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].user_value =
+                    strb_word(regs_q.partition[idx].user_value, reg_req_i.wdata, reg_req_i.wstrb);
+              end
+            end
+            32'h10: begin
+              reg_resp_o.rdata = regs_q.partition[idx].way_mask[31:0];
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].way_mask[31:0] =
+                    strb_word(regs_q.partition[idx].way_mask[31:0], reg_req_i.wdata,
+                              reg_req_i.wstrb);
+              end
+            end
+            32'h14: begin
+              reg_resp_o.rdata = regs_q.partition[idx].way_mask[63:32];
+              if (reg_req_i.write) begin
+                regs_d.partition[idx].way_mask[63:32] =
+                    strb_word(regs_q.partition[idx].way_mask[63:32], reg_req_i.wdata,
+                              reg_req_i.wstrb);
+              end
+            end
+            32'h18: begin
+              reg_resp_o.rdata = {31'b0, regs_q.partition[idx].en};
+              if (reg_req_i.write && reg_req_i.wstrb[0]) begin
+                regs_d.partition[idx].en = reg_req_i.wdata[0];
+              end
+            end
+            default: reg_resp_o.error = 1'b1;
+          endcase
+        end else begin
+          reg_resp_o.error = 1'b1;
+        end
+      end else if (reg_req_i.addr < FlushBase) begin
+        // Partition hit and miss counters
+        idx    = (reg_req_i.addr - CntBase) / CntStride;
+        offset = (reg_req_i.addr - CntBase) % CntStride;
+        if (idx < NumParts) begin
+          unique case (offset)
+            32'h00:  reg_resp_o.rdata = hit_cnt_q[idx][31:0];
+            32'h04:  reg_resp_o.rdata = hit_cnt_q[idx][63:32];
+            32'h08:  reg_resp_o.rdata = miss_cnt_q[idx][31:0];
+            32'h0C:  reg_resp_o.rdata = miss_cnt_q[idx][63:32];
+            default: reg_resp_o.error = 1'b1;
+          endcase
+          if (reg_req_i.write && !reg_resp_o.error) begin
+            if (offset < 32'h08) begin
+              hit_cnt_d[idx] = '0;
+            end else begin
+              miss_cnt_d[idx] = '0;
+            end
+          end
+        end else begin
+          reg_resp_o.error = 1'b1;
+        end
+      end else if (reg_req_i.addr < PostedBase) begin
+        // Background flush
+        unique case (reg_req_i.addr - FlushBase)
+          32'h00: begin
+            reg_resp_o.rdata = {30'b0, regs_q.flush.range, 1'b0};
+            if (reg_req_i.write && reg_req_i.wstrb[0]) begin
+              regs_d.flush.start = reg_req_i.wdata[0];
+              regs_d.flush.range = reg_req_i.wdata[1];
+            end
+          end
+          32'h04: begin
+            reg_resp_o.rdata = {31'b0, regs_i.flush_busy};
+            reg_resp_o.error = reg_req_i.write;
+          end
+          32'h08: begin
+            reg_resp_o.rdata = regs_q.flush.start_addr[31:0];
+            if (reg_req_i.write) begin
+              regs_d.flush.start_addr[31:0] =
+                  strb_word(regs_q.flush.start_addr[31:0], reg_req_i.wdata, reg_req_i.wstrb);
+            end
+          end
+          32'h0C: begin
+            reg_resp_o.rdata = regs_q.flush.start_addr[63:32];
+            if (reg_req_i.write) begin
+              regs_d.flush.start_addr[63:32] =
+                  strb_word(regs_q.flush.start_addr[63:32], reg_req_i.wdata, reg_req_i.wstrb);
+            end
+          end
+          32'h10: begin
+            reg_resp_o.rdata = regs_q.flush.end_addr[31:0];
+            if (reg_req_i.write) begin
+              regs_d.flush.end_addr[31:0] =
+                  strb_word(regs_q.flush.end_addr[31:0], reg_req_i.wdata, reg_req_i.wstrb);
+            end
+          end
+          32'h14: begin
+            reg_resp_o.rdata = regs_q.flush.end_addr[63:32];
+            if (reg_req_i.write) begin
+              regs_d.flush.end_addr[63:32] =
+                  strb_word(regs_q.flush.end_addr[63:32], reg_req_i.wdata, reg_req_i.wstrb);
+            end
+          end
+          32'h18: begin
+            reg_resp_o.rdata = flush_cnt_q;
+            if (reg_req_i.write) begin
+              flush_cnt_d = '0;
+            end
+          end
+          default: reg_resp_o.error = 1'b1;
+        endcase
+      end else begin
+        // Posted writes
+        unique case (reg_req_i.addr - PostedBase)
+          32'h00: begin
+            reg_resp_o.rdata = {30'b0, regs_q.posted.irq_en, regs_q.posted.en};
+            if (reg_req_i.write && reg_req_i.wstrb[0]) begin
+              regs_d.posted.en     = reg_req_i.wdata[0];
+              regs_d.posted.irq_en = reg_req_i.wdata[1];
+            end
+          end
+          32'h04: begin
+            reg_resp_o.rdata = {29'b0, posted_resp_q, posted_err_q};
+            // an error of this cycle stays pending
+            if (reg_req_i.write && reg_req_i.wstrb[0] && reg_req_i.wdata[0] &&
+                (regs_i.posted_errs == '0)) begin
+              posted_err_d  = 1'b0;
+              posted_resp_d = axi_pkg::RESP_OKAY;
+            end
+          end
+          32'h08: begin
+            reg_resp_o.rdata = posted_cnt_q;
+            if (reg_req_i.write) begin
+              posted_cnt_d = '0;
+            end
+          end
+          default: reg_resp_o.error = 1'b1;
+        endcase
+      end
+    end
+  end
+
+  // pragma translate_off
+`ifndef VERILATOR
+  initial begin : proc_check_params
+    num_regions :
+    assert (NumRegions * RegionStride <= PartBase)
+    else $fatal(1, "Parameter `NumAddrRegions` does not fit into the register map!");
+    num_parts :
+    assert ((NumParts * PartStride <= CntBase - PartBase) && (NumParts > 32'd0))
+    else $fatal(1, "Parameter `NumPartitions` does not fit into the register map!");
+    num_cnts :
+    assert (NumParts * CntStride <= FlushBase - CntBase)
+    else $fatal(1, "Parameter `NumPartitions` does not fit into the counter map!");
+  end
+`endif
+  // pragma translate_on
+
+endmodule
@@ -0,0 +1,195 @@
+// Copyright 2023 Bruno Sá and ZeroDay Labs.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+//
+// Author: Bruno Sá <bruno.vilaca.sa@gmail.com>
+// Date:   07.12.2023
+
+`include "common_cells/registers.svh"
+
+/// Tag word buffer of a slave port.
+///
+/// Keeps the last tag words the (module.axi_tagctrl_r) unit of the port got from the tag cache.
+/// A tagged AR burst which lies inside a single tag word looks it up when it is accepted. On a hit
+/// the tag word travels in the R descriptor and no tag cache descriptor is made for the burst.
+///
+/// The buffered tag words follow the writes of all slave ports:
+/// * The tag updates of the W unit of the same port are merged into the buffered tag word. They
+///   reach the tag cache in the same order.
+/// * A tagged AW of another port invalidates the tag words of its burst.
+/// * A tag word from the tag cache is only buffered if no tagged write was waiting for its tag
+///   cache response when the AR was accepted, and no tagged AW was accepted until the tag word
+///   arrived. Otherwise it could lack a write the buffer already saw. The R unit takes the tag
+///   words in AR order, so the fetches in flight at a tagged AW are counted and dropped.
+module axi_tagctrl_tag_buf #(
+    /// Tag Controller configuration struct. Passed down from `axi_tagctrl_top.sv`.
+    parameter axi_tagctrl_pkg::tagctrl_cfg_t Cfg = axi_tagctrl_pkg::tagctrl_cfg_t'{default: '0},
+    /// Number of slave ports, see `NumSlvPorts` of (module.axi_tagctrl_top).
+    parameter int unsigned NumSlvPorts = 32'd1,
+    /// Index of the slave port of this buffer.
+    parameter int unsigned PortIdx = 32'd0,
+    /// Number of buffered tag words, see `axi_tagctrl_pkg::TagBufEntries`.
+    parameter int unsigned NumEntries = 32'd4
+) (
+    /// Clock, positive edge triggered.
+    input logic clk_i,
+    /// Asynchronous reset, active low.
+    input logic rst_ni,
+    /// A tagged AR of the port is accepted.
+    input logic lookup_valid_i,
+    /// First tag word of the AR burst, relative to `DRAMMemBase`.
+    input logic [Cfg.AxiAddrWidth-1:0] lookup_first_i,
+    /// Last tag word of the AR burst, relative to `DRAMMemBase`.
+    input logic [Cfg.AxiAddrWidth-1:0] lookup_last_i,
+    /// The AR burst lies inside a buffered tag word.
+    output logic lookup_hit_o,
+    /// Buffered tag word of the AR burst.
+    output logic [Cfg.AxiDataWidth-1:0] lookup_data_o,
+    /// The tag word of the AR burst is buffered once it arrives from the tag cache.
+    output logic lookup_fill_o,
+    /// The R unit got the tag word of an AR burst which had `lookup_fill_o` set.
+    input logic fill_valid_i,
+    /// Tag word index of the arrived tag word.
+    input logic [Cfg.AxiAddrWidth-1:0] fill_word_i,
+    /// Arrived tag word.
+    input logic [Cfg.AxiDataWidth-1:0] fill_data_i,
+    /// The W unit of the port pushed a tag update towards the tag cache.
+    input logic upd_valid_i,
+    /// Tag word index of the tag update.
+    input logic [Cfg.AxiAddrWidth-1:0] upd_word_i,
+    /// Tag bits of the tag update.
+    input logic [Cfg.AxiDataWidth-1:0] upd_data_i,
+    /// Written tag bits of the tag update.
+    input logic [Cfg.AxiDataWidth-1:0] upd_bit_en_i,
+    /// A tagged AW of the slave port is accepted.
+    input logic [NumSlvPorts-1:0] wr_valid_i,
+    /// First tag word of the AW burst of the slave port.
+    input logic [NumSlvPorts-1:0][Cfg.AxiAddrWidth-1:0] wr_first_i,
+    /// Last tag word of the AW burst of the slave port.
+    input logic [NumSlvPorts-1:0][Cfg.AxiAddrWidth-1:0] wr_last_i,
+    /// Tagged writes of any slave port wait for their tag cache response.
+    input logic wr_pending_i
+);
+  typedef logic [Cfg.AxiAddrWidth-1:0] word_t;
+  typedef logic [Cfg.AxiDataWidth-1:0] data_t;
+  typedef logic [cf_math_pkg::idx_width(NumEntries)-1:0] idx_t;
+  // Fetches in flight, one per AR burst between the AX unit and the tag words buffered in the R
+  // unit: the AX register, the descriptor FIFO to the R unit, the burst of the R unit and its
+  // tag word FIFO
+  localparam int unsigned MaxFetches = Cfg.TagAXFifoDepth + Cfg.TagRFifoDepth + 32'd2;
+  typedef logic [$clog2(MaxFetches+1)-1:0] cnt_t;
+
+  typedef struct packed {
+    logic  valid;
+    word_t word;
+    data_t data;
+  } entry_t;
+
+  entry_t [NumEntries-1:0] entry_d, entry_q;
+  // next entry replaced when all of them are valid
+  idx_t victim_d, victim_q;
+  // tag words fetched for the buffer which did not arrive yet
+  cnt_t fetch_cnt_d, fetch_cnt_q;
+  // number of the next arriving tag words which are dropped
+  cnt_t drop_cnt_d, drop_cnt_q;
+  logic [NumEntries-1:0] lookup_match;
+  // a tagged AW of any slave port is accepted
+  logic wr_any;
+
+  assign wr_any = |wr_valid_i;
+
+  always_comb begin : proc_lookup
+    lookup_data_o = '0;
+    for (int unsigned i = 0; i < NumEntries; i++) begin
+      lookup_match[i] = entry_q[i].valid && (entry_q[i].word == lookup_first_i);
+      if (lookup_match[i]) begin
+        lookup_data_o = entry_q[i].data;
+      end
+    end
+  end
+
+  assign lookup_hit_o  = (lookup_first_i == lookup_last_i) && (|lookup_match);
+  assign lookup_fill_o = (lookup_first_i == lookup_last_i) && !(|lookup_match) && !wr_pending_i &&
+      !wr_any;
+
+  always_comb begin : proc_entries
+    automatic idx_t fill_idx = victim_q;
+    automatic logic fill_found = 1'b0;
+    entry_d     = entry_q;
+    victim_d    = victim_q;
+    fetch_cnt_d = fetch_cnt_q;
+    drop_cnt_d  = drop_cnt_q;
+
+    // tag updates of the W unit of the port
+    if (upd_valid_i) begin
+      for (int unsigned i = 0; i < NumEntries; i++) begin
+        if (entry_q[i].valid && (entry_q[i].word == upd_word_i)) begin
+          entry_d[i].data = (entry_q[i].data & ~upd_bit_en_i) | (upd_data_i & upd_bit_en_i);
+        end
+      end
+    end
+
+    // AW bursts of the other ports
+    for (int unsigned p = 0; p < NumSlvPorts; p++) begin
+      if ((p != PortIdx) && wr_valid_i[p]) begin
+        for (int unsigned i = 0; i < NumEntries; i++) begin
+          if ((entry_q[i].word >= wr_first_i[p]) && (entry_q[i].word <= wr_last_i[p])) begin
+            entry_d[i].valid = 1'b0;
+          end
+        end
+      end
+    end
+
+    if (lookup_valid_i && lookup_fill_o) begin
+      fetch_cnt_d = fetch_cnt_q + cnt_t'(1);
+    end
+    if (fill_valid_i) begin
+      fetch_cnt_d = fetch_cnt_d - cnt_t'(1);
+    end
+
+    if (wr_any) begin
+      // the fetches in flight may miss the write, the arriving one is dropped right away
+      drop_cnt_d = fetch_cnt_q - cnt_t'(fill_valid_i);
+    end else if (fill_valid_i && (drop_cnt_q != '0)) begin
+      drop_cnt_d = drop_cnt_q - cnt_t'(1);
+    end else if (fill_valid_i) begin
+      // refresh the tag word if it is already buffered, otherwise take the first free entry or
+      // the victim
+      for (int i = NumEntries - 1; i >= 0; i--) begin
+        if (!entry_d[i].valid) begin
+          fill_idx  = idx_t'(i);
+          fill_found = 1'b1;
+        end
+      end
+      for (int unsigned i = 0; i < NumEntries; i++) begin
+        if (entry_d[i].valid && (entry_d[i].word == fill_word_i)) begin
+          fill_idx  = idx_t'(i);
+          fill_found = 1'b1;
+        end
+      end
+      if (!fill_found) begin
+        victim_d = (victim_q == idx_t'(NumEntries - 1)) ? '0 : victim_q + idx_t'(1);
+      end
+      entry_d[fill_idx] = entry_t'{valid: 1'b1, word: fill_word_i, data: fill_data_i};
+    end
+  end
+
+  `FF(entry_q, entry_d, '0, clk_i, rst_ni)
+  `FF(victim_q, victim_d, '0, clk_i, rst_ni)
+  `FF(fetch_cnt_q, fetch_cnt_d, '0, clk_i, rst_ni)
+  `FF(drop_cnt_q, drop_cnt_d, '0, clk_i, rst_ni)
+
+  // pragma translate_off
+  always_ff @(posedge clk_i) begin : proc_check_fetch_cnt
+    if (rst_ni) begin
+      fetch_cnt :
+      assert (!fill_valid_i || (fetch_cnt_q != '0))
+      else $fatal(1, "A tag word arrived for the buffer without a fetch in flight!");
+      fetch_cnt_max :
+      assert (!(lookup_valid_i && lookup_fill_o && !fill_valid_i) || (fetch_cnt_q < MaxFetches))
+      else $fatal(1, "More fetches of the tag word buffer in flight than `MaxFetches`!");
+    end
+  end
+  // pragma translate_on
+
+endmodule
@@ -11,13 +11,26 @@
 ///   The pattern gets written or read to all macros, BIST resulte gets activated
 /// `axi_llc_pkg::Flush`:
 ///   Perform a way trageted eviction, the tag is written in with all zero.
+///   A request with `clean` set only writes back a dirty line and keeps it valid. With `match`
+///   set, the line is only cleaned if it holds the requested tag.
 /// `axi_llc_pkg::Lookup`:
 ///   Perform a tag lookup in all non SPM ways, hit/eviction gets set if needed.
 ///   Writes the tag into the macro if needed.
+///
+/// The lines are sectored, each block of a line has its own valid and dirty bit. A lookup only
+/// hits if the tag matches and all blocks in `req_i.blk` are valid. If the tag matches but
+/// some blocks are missing, the lookup is a sector miss: the line is kept, only the missing
+/// blocks of `req_i.fetch` are refilled and nothing is evicted. `res_o.refill_blk` are the blocks
+/// to refill and `res_o.evict_blk` the dirty blocks of an evicted or flushed line.
+///
+/// The victim way of a missing lookup is chosen by (module.axi_tagctrl_evict_box) with the
+/// replacement policy `ReplPolicy`. Every completed lookup updates the replacement state.
 `include "common_cells/registers.svh"
-module axi_llc_tag_store #(
+module axi_tagctrl_tag_store #(
   /// Static LLC configuration struct
   parameter axi_llc_pkg::llc_cfg_t Cfg = axi_llc_pkg::llc_cfg_t'{default: '0},
+  /// Replacement policy of the tag cache
+  parameter axi_tagctrl_pkg::repl_policy_e ReplPolicy = axi_tagctrl_pkg::ReplRandom,
   /// Way indicator type
   /// EG: typedef logic [Cfg.SetAssociativity-1:0] way_ind_t;
   parameter type way_ind_t = logic,
@@ -65,15 +78,20 @@ module axi_llc_tag_store #(
   // typedef, because we use in this module many signals with the width of SetAssiciativity
   typedef logic [Cfg.IndexLength-1:0] index_t; // index type (equals the address for sram)
   typedef logic [Cfg.TagLength-1:0]   tag_t;
+  typedef logic [Cfg.NumBlocks-1:0]   blk_t;   // one bit per block of a line
 
   // typedef to have consistent tag data (that what gets written into the sram)
-  localparam int unsigned TagDataLen = Cfg.TagLength + 32'd2;
+  localparam int unsigned TagDataLen = Cfg.TagLength + 32'd2 + 32'd2 * Cfg.NumBlocks;
   /// Packed struct for the data stored in the memory macros.
   typedef struct packed {
     /// The tag stored is valid.
     logic val;
-    /// The tag stored is dirty.
+    /// The tag stored is dirty, one of the blocks is dirty.
     logic dit;
+    /// The blocks of the line which are valid.
+    blk_t blk_val;
+    /// The blocks of the line which are dirty.
+    blk_t blk_dit;
     /// The stored tag itself.
     tag_t tag;
   } tag_data_t;
@@ -106,6 +124,8 @@ module axi_llc_tag_store #(
   tag_data_t  [Cfg.SetAssociativity-1:0] stored_tag;
   // Binary representation of the selected output indicator
   bin_ind_t   bin_ind;
+  // Stored data of the hitting way and what gets written back on a tag hit
+  tag_data_t  hit_data,    hit_wdata;
   // The pattern generation unit signals
   logic       gen_valid,   gen_ready;
   index_t     gen_index;
@@ -115,6 +135,7 @@ module axi_llc_tag_store #(
   logic       bist_valid,  gen_eoc;
   // Evict box signals
   logic       evict_req,   evict_valid;
+  logic       repl_update;
   // Response output into the spill register
   store_res_t res;
   logic       res_valid,   res_ready;
@@ -166,18 +187,14 @@ module axi_llc_tag_store #(
 
             // Do we have to write back something?
             if (res_valid && res_ready) begin
-              if (res.hit) begin
-                // This is a hit
-                if (req_q.dirty && !tag_dit[bin_ind]) begin
-                  // Do we have to store a dirty as the hit was not dirty until now?
-                  ram_req   = res.indicator;
-                  ram_we    = res.indicator;
-                  ram_index = req_q.index;
-                  ram_wdata = tag_data_t'{
-                                val: 1'b1,
-                                dit: 1'b1,
-                                tag: req_q.tag
-                              };
+              if (|hit) begin
+                // The tag hit, either all blocks are there or this is a sector miss.
+                if (hit_wdata != hit_data) begin
+                  // Do we have to store new valid or dirty blocks?
+                  ram_req     = res.indicator;
+                  ram_we      = res.indicator;
+                  ram_index   = req_q.index;
+                  ram_wdata   = hit_wdata;
                   switch_busy = 1'b1;
                 end else begin
                   // Noting to write back, do we have a new LOOKUP request?
@@ -199,9 +216,11 @@ module axi_llc_tag_store #(
                 ram_we    = res.indicator;
                 ram_index = req_q.index;
                 ram_wdata = tag_data_t'{
-                              val: 1'b1,
-                              dit: req_q.dirty,
-                              tag: req_q.tag
+                              val:     1'b1,
+                              dit:     req_q.dirty,
+                              blk_val: req_q.fetch,
+                              blk_dit: req_q.dirty ? req_q.blk : blk_t'(0),
+                              tag:     req_q.tag
                             };
                 // Go back to idle.
                 switch_busy = 1'b1;
@@ -215,11 +234,20 @@ module axi_llc_tag_store #(
             end
 
             // Write back all zeros to the storage if the output is acknowledged.
+            // A cleaned line only loses its dirty flag.
             if (res_valid && res_ready) begin
-              ram_req     = req_q.indicator;
-              ram_we      = req_q.indicator;
-              ram_index   = req_q.index;
-              ram_wdata   = tag_data_t'{default: '0};
+              if (!req_q.clean || res.evict) begin
+                ram_req   = req_q.indicator;
+                ram_we    = req_q.indicator;
+                ram_index = req_q.index;
+              end
+              ram_wdata   = req_q.clean ? tag_data_t'{
+                                            val:     1'b1,
+                                            dit:     1'b0,
+                                            blk_val: stored_tag[bin_ind].blk_val,
+                                            blk_dit: blk_t'(0),
+                                            tag:     stored_tag[bin_ind].tag
+                                          } : tag_data_t'{default: '0};
               switch_busy = 1'b1;
             end
           end
@@ -299,9 +327,11 @@ module axi_llc_tag_store #(
 
     // comparator (XNOR)
     assign ram_compared = tag_data_t'{
-          val: bist_pattern.val,
-          dit: bist_pattern.dit,
-          tag: (req_q.mode == axi_llc_pkg::Bist) ? bist_pattern.tag : req_q.tag
+          val:     bist_pattern.val,
+          dit:     bist_pattern.dit,
+          blk_val: bist_pattern.blk_val,
+          blk_dit: bist_pattern.blk_dit,
+          tag:     (req_q.mode == axi_llc_pkg::Bist) ? bist_pattern.tag : req_q.tag
         } ~^ ram_rdata;
     assign tag_equ[i] = &ram_compared.tag; // valid if the stored tag equals the one looked up
     assign tag_val[i] = ram_rdata.val;     // indicates where valid values are in the line
@@ -309,8 +339,9 @@ module axi_llc_tag_store #(
 
     // hit detection
     assign hit[i]        = req_q.indicator[i] & tag_val[i] & tag_equ[i];
-    // BIST also add the two bits of valid and dirty
-    assign bist_res[i]   = ram_compared.val & ram_compared.dit & tag_equ[i];
+    // BIST also add the bits of valid and dirty
+    assign bist_res[i]   = ram_compared.val & ram_compared.dit & (&ram_compared.blk_val) &
+                           (&ram_compared.blk_dit) & tag_equ[i];
     // assignment to wide output signal that goes to the tag output mux
     assign stored_tag[i] = ram_rdata;
   end
@@ -350,21 +381,48 @@ module axi_llc_tag_store #(
   way_ind_t evict_way_ind;
   logic     evict_flag;
 
-  axi_llc_evict_box #(
-    .Cfg       ( Cfg       ),
-    .way_ind_t ( way_ind_t )
+  // The replacement state follows every lookup which leaves the tag store.
+  assign repl_update = res_valid & res_ready & (req_q.mode == axi_llc_pkg::Lookup);
+
+  axi_tagctrl_evict_box #(
+    .Cfg        ( Cfg        ),
+    .ReplPolicy ( ReplPolicy ),
+    .way_ind_t  ( way_ind_t  ),
+    .index_t    ( index_t    )
   ) i_evict_box (
     .clk_i,
     .rst_ni,
-    .req_i       ( evict_req     ),
-    .tag_valid_i ( tag_val       ),
-    .tag_dirty_i ( tag_dit       ),
-    .spm_lock_i  ( spm_lock_i    ),
-    .way_ind_o   ( evict_way_ind ),
-    .evict_o     ( evict_flag    ),
-    .valid_o     ( evict_valid   )
+    .req_i          ( evict_req     ),
+    .index_i        ( req_q.index   ),
+    .tag_valid_i    ( tag_val       ),
+    .tag_dirty_i    ( tag_dit       ),
+    .spm_lock_i     ( spm_lock_i    ),
+    .way_ind_o      ( evict_way_ind ),
+    .evict_o        ( evict_flag    ),
+    .valid_o        ( evict_valid   ),
+    .update_i       ( repl_update   ),
+    .update_index_i ( req_q.index   ),
+    .update_way_i   ( res.indicator ),
+    .update_hit_i   ( |hit          )
   );
 
+  // The hitting way is one-hot, select its stored data.
+  always_comb begin : proc_hit_data
+    hit_data = tag_data_t'{default: '0};
+    for (int unsigned i = 0; i < Cfg.SetAssociativity; i++) begin
+      if (hit[i]) begin
+        hit_data = stored_tag[i];
+      end
+    end
+    // Refilled blocks get valid, written blocks dirty.
+    hit_wdata         = hit_data;
+    hit_wdata.blk_val = hit_data.blk_val | res.refill_blk;
+    if (req_q.dirty) begin
+      hit_wdata.blk_dit = hit_data.blk_dit | req_q.blk;
+      hit_wdata.dit     = 1'b1;
+    end
+  end
+
   onehot_to_bin #(
     .ONEHOT_WIDTH ( Cfg.SetAssociativity )
   ) i_onehot_to_bin (
@@ -380,19 +438,24 @@ module axi_llc_tag_store #(
       unique case (req_q.mode)
         axi_llc_pkg::Lookup: begin
           res = store_res_t'{
-            indicator: (|hit) ? hit       : evict_way_ind,
-            hit:       (|hit) ? 1'b1      : 1'b0,
-            evict:     (|hit) ? 1'b0      : evict_flag,
-            evict_tag: (|hit) ? tag_t'(0) : stored_tag[bin_ind].tag,
-            default:   '0
+            indicator:  (|hit) ? hit       : evict_way_ind,
+            hit:        (|hit) ? ((req_q.blk & ~hit_data.blk_val) == blk_t'(0)) : 1'b0,
+            evict:      (|hit) ? 1'b0      : evict_flag,
+            evict_tag:  (|hit) ? tag_t'(0) : stored_tag[bin_ind].tag,
+            evict_blk:  (|hit) ? blk_t'(0) : stored_tag[bin_ind].blk_dit,
+            refill_blk: (|hit) ? (((req_q.blk & ~hit_data.blk_val) == blk_t'(0)) ? blk_t'(0) :
+                                  (req_q.fetch & ~hit_data.blk_val)) : req_q.fetch,
+            default:    '0
           };
         end
         axi_llc_pkg::Flush: begin
           res = store_res_t'{
             indicator: req_q.indicator,
             hit:       1'b0,
-            evict:     stored_tag[bin_ind].val & stored_tag[bin_ind].dit,
+            evict:     stored_tag[bin_ind].val & stored_tag[bin_ind].dit &
+                       (!req_q.clean || !req_q.match || tag_equ[bin_ind]),
             evict_tag: stored_tag[bin_ind].tag,
+            evict_blk: stored_tag[bin_ind].blk_dit,
             default:   '0
           };
         end
@@ -51,8 +51,16 @@ module axi_tagctrl_top #(
     /// Note on restrictions:
     /// The same restriction as of parameter `NumLines` applies.
     parameter int unsigned NumBlocks        = 32'd0,
-    /// AXI4+ATOP ID field width of the slave port.
-    /// The ID field width of the master port is this parameter + 1.
+    /// Replacement policy of the tag cache, see (module.axi_tagctrl_evict_box).
+    parameter axi_tagctrl_pkg::repl_policy_e ReplPolicy = axi_tagctrl_pkg::ReplRandom,
+    /// Number of AXI4+ATOP slave ports. Every port has its own AX, R and W units, all of them
+    /// share the tag cache and the master port.
+    parameter int unsigned NumSlvPorts      = 32'd1,
+    /// Tag cache descriptors of each slave port per arbitration round, see
+    /// (module.axi_tagctrl_port_arb).
+    parameter int unsigned SlvPortWeights[NumSlvPorts] = '{default: 32'd1},
+    /// AXI4+ATOP ID field width of the slave ports.
+    /// The ID field width of the master port is this parameter + `$clog2(NumSlvPorts + 1)`.
     parameter int unsigned AxiIdWidth       = 32'd6,
     /// AXI4+ATOP address field width of both the slave and master port.
     parameter int unsigned AxiAddrWidth     = 32'd64,
@@ -98,10 +106,10 @@ module axi_tagctrl_top #(
     input logic rst_ni,
     /// Test mode activate, active high.
     input logic test_i,
-    /// AXI4+ATOP slave port request, CPU side
-    input slv_req_t slv_req_i,
-    /// AXI4+ATOP slave port response, CPU side
-    output slv_resp_t slv_resp_o,
+    /// AXI4+ATOP slave port requests, CPU side
+    input slv_req_t [NumSlvPorts-1:0] slv_req_i,
+    /// AXI4+ATOP slave port responses, CPU side
+    output slv_resp_t [NumSlvPorts-1:0] slv_resp_o,
     /// AXI4+ATOP master port request, memory side
     output mst_req_t mst_req_o,
     /// AXI4+ATOP master port response, memory side
@@ -110,18 +118,27 @@ module axi_tagctrl_top #(
     input conf_regs_q_t conf_regs_i,
     /// Configuration registers HW -> Registers
     output conf_regs_d_t conf_regs_o,
+    /// Tag controller configuration registers Registers -> HW
+    input axi_tagctrl_pkg::tagctrl_regs_q_t tagctrl_regs_i,
+    /// Tag controller status events HW -> Registers
+    output axi_tagctrl_pkg::tagctrl_regs_d_t tagctrl_regs_o,
     /// Start of address region mapped to cache
     input axi_addr_t cached_start_addr_i,
     /// End of address region mapped to cache
     input axi_addr_t cached_end_addr_i
 );
   `include "axi/typedef.svh"
+  `include "common_cells/registers.svh"
   // Axi parameters are accumulated in a struct for further use.
   localparam axi_llc_pkg::llc_axi_cfg_t AxiCfg = axi_llc_pkg::llc_axi_cfg_t
 '{SlvPortIdWidth: AxiIdWidth, AddrWidthFull: AxiAddrWidth, DataWidthFull: AxiDataWidth};
 
+  // The memory side `axi_mux` has a port for each slave port and one for the tag cache
+  localparam int unsigned MstIdExtWidth = $clog2(NumSlvPorts + 32'd1);
+
   typedef logic [AxiCfg.SlvPortIdWidth-1:0] axi_slv_id_t;
-  typedef logic [AxiCfg.SlvPortIdWidth:0] axi_mst_id_t;
+  typedef logic [AxiCfg.SlvPortIdWidth+MstIdExtWidth-1:0] axi_mst_id_t;
+  typedef logic [cf_math_pkg::idx_width(NumSlvPorts)-1:0] port_idx_t;
   typedef logic [AxiCfg.DataWidthFull-1:0] axi_data_t;
   typedef logic [(AxiCfg.DataWidthFull/8)-1:0] axi_strb_t;
   typedef logic [AxiUserWidth-1:0] axi_user_t;
@@ -192,8 +209,13 @@ module axi_tagctrl_top #(
     logic [Cfg.tagc_cfg.SetAssociativity-1:0] way_ind;  // way we have to perform an operation on
     logic evict;  // evict what is standing in the line
     logic [Cfg.tagc_cfg.TagLength -1:0] evict_tag;  // tag for evicting a line
+    logic [Cfg.tagc_cfg.NumBlocks -1:0] evict_blk;  // dirty blocks of the evicted line
     logic refill;  // refill the cache line
+    logic [Cfg.tagc_cfg.NumBlocks -1:0] refill_blk;  // blocks of the line to refill
     logic flush;  // flush this line, comes from config
+    logic clean;  // write back a dirty line and keep it valid, comes from the flush unit
+    logic clean_match;  // only clean the line if it holds the tag of `a_x_addr`
+    axi_tagctrl_pkg::part_idx_t part;  // way partition of the requester
   } tagc_desc_t;
 
   // definition of the structs that are between the units and the ways
@@ -258,42 +280,91 @@ module axi_tagctrl_top #(
     logic [Cfg.tagc_cfg.TagLength -1:0] evict_tag;  // tag for evicting a line
     logic refill;  // refill the cache line
     logic flush;  // flush this line, comes from config
+    logic untagged;  // access to an untagged region, bypasses the tag cache
+    logic tag_hit;  // the tag word comes from the tag word buffer, in `tag_data`
+    logic tag_fill;  // the tag word of the tag cache is filled into the tag word buffer
+    axi_data_t tag_data;  // tag word of the tag word buffer
+    axi_pkg::atop_t atop;  // atomic operation of an AW burst
   } tagctrl_desc_t;
 
+  // The tag cache descriptors of a slave port carry the ID `AxReqId ^ port`, see
+  // (module.axi_tagctrl_ax). The tag words and write responses of the tag cache are routed back
+  // to the port with it.
+  function automatic port_idx_t tagc_port(axi_slv_id_t id);
+    return port_idx_t'(id ^ axi_slv_id_t'(axi_tagctrl_pkg::AxReqId));
+  endfunction
+
+  // The port index XORed into `AxReqId` has to stay below the atomic ID bit. Checked at
+  // elaboration, Verilator included.
+  if ((NumSlvPorts == 32'd0) || (NumSlvPorts > 2 ** (AxiIdWidth - 1))) begin : gen_port_id_err
+    $error("Parameter `NumSlvPorts` has to be > 0 and fit below the atomic ID bit!");
+  end
+
+  // Atomics flip the ID bit `AxiIdWidth-1` of their memory requests and of the tag cache reads of
+  // their old tag word, see (module.axi_tagctrl_ax).
+  function automatic logic atop_id(axi_slv_id_t id);
+    return (id ^ axi_slv_id_t'(axi_tagctrl_pkg::AxReqId)) >> (AxiIdWidth - 1);
+  endfunction
+
+  // Tag cache line of an address of the tag cache
+  function automatic axi_addr_t tagc_line(axi_addr_t addr);
+    return addr >> (LLC_Cfg.ByteOffsetLength + LLC_Cfg.BlockOffsetLength);
+  endfunction
+
   // R tag bits payload between the tag cache and tag controller
   tagc_inp_t tagc_r_inp;
   logic tagc_r_inp_valid, tagc_r_inp_ready;
+  logic [NumSlvPorts-1:0] port_r_inp_valid, port_r_inp_ready;
+  // old tag words of atomics
+  logic [NumSlvPorts-1:0] port_atop_tag_valid, port_atop_tag_ready;
 
   // W tag bits payload between the tag controller and tag cache
   tagc_oup_t tagc_w_oup;
   logic tagc_w_oup_valid, tagc_w_oup_ready;
+  tagc_oup_t [NumSlvPorts-1:0] port_w_oup;
+  logic [NumSlvPorts-1:0] port_w_oup_valid, port_w_oup_ready;
   slv_b_chan_t tagc_b_chan;
   logic tagc_b_chan_valid, tagc_b_chan_ready;
+  logic [NumSlvPorts-1:0] port_b_chan_valid, port_b_chan_ready;
+
+  // slave ports after the cut and the flush isolation
+  slv_req_t [NumSlvPorts-1:0] slv_req_cut, to_tagctrl_req;
+  slv_resp_t [NumSlvPorts-1:0] slv_resp_cut, from_tagctrl_resp;
+  logic [NumSlvPorts-1:0] port_isolated;
 
   // tag controller and tag cache connection to the memory
-  slv_req_t to_tagctrl_req, tagctrl_req, tagc_req;
-  slv_resp_t from_tagctrl_resp, tagctrl_resp, tagc_resp;
+  slv_req_t [NumSlvPorts-1:0] tagctrl_req;
+  slv_resp_t [NumSlvPorts-1:0] tagctrl_resp;
+  slv_req_t tagc_req;
+  slv_resp_t tagc_resp;
+  slv_req_t [NumSlvPorts:0] mem_req;
+  slv_resp_t [NumSlvPorts:0] mem_resp;
 
   // signals between channel splitters and rw_arb_tree
-  tagc_desc_t [2:0] ax_desc;
-  logic       [2:0] ax_desc_valid;
-  logic       [2:0] ax_desc_ready;
+  tagc_desc_t [3:0] ax_desc;
+  logic       [3:0] ax_desc_valid;
+  logic       [3:0] ax_desc_ready;
+
+  // tag cache descriptors of the AR and AW units of the slave ports to the port arbiters
+  tagc_desc_t [NumSlvPorts-1:0] port_ar_desc, port_aw_desc;
+  logic [NumSlvPorts-1:0] port_ar_valid, port_ar_ready, port_aw_valid, port_aw_ready;
+  logic [NumSlvPorts-1:0] port_aw_arb_valid, port_aw_arb_ready;
 
   // descriptor from the tagctrl_ar to the ar FIFO
-  tagc_desc_t       tagctrl_ar_desc;
-  logic tagctrl_ar_valid, tagctrl_ar_ready;
+  tagctrl_desc_t [NumSlvPorts-1:0] tagctrl_ar_desc;
+  logic [NumSlvPorts-1:0] tagctrl_ar_valid, tagctrl_ar_ready;
 
   // descriptor from the ar FIFO to the tagctrl_r unit
-  tagc_desc_t tagctrl_r_desc;
-  logic tagctrl_r_valid, tagctrl_r_ready;
+  tagctrl_desc_t [NumSlvPorts-1:0] tagctrl_r_desc;
+  logic [NumSlvPorts-1:0] tagctrl_r_valid, tagctrl_r_ready;
 
   // descriptor from the tagctrl_aw to the aw FIFO
-  tagc_desc_t tagctrl_aw_desc;
-  logic tagctrl_aw_valid, tagctrl_aw_ready;
+  tagctrl_desc_t [NumSlvPorts-1:0] tagctrl_aw_desc;
+  logic [NumSlvPorts-1:0] tagctrl_aw_valid, tagctrl_aw_ready;
 
   // descriptor from the aw FIFO to the tagctrl_w unit
-  tagc_desc_t tagctrl_w_desc;
-  logic tagctrl_w_valid, tagctrl_w_ready;
+  tagctrl_desc_t [NumSlvPorts-1:0] tagctrl_w_desc;
+  logic [NumSlvPorts-1:0] tagctrl_w_valid, tagctrl_w_ready;
 
   // descriptor from rw_arb_tree to spill register to cut longest path (hit miss detect)
   tagc_desc_t rw_desc;
@@ -319,6 +390,8 @@ module axi_tagctrl_top #(
   // descriptor from the merge_unit to the write_unit
   tagc_desc_t write_desc;
   logic write_desc_valid, write_desc_ready;
+  // the write unit takes a descriptor, and the tag word mux can queue its port
+  logic write_unit_ready, w_sel_ready;
 
   // descriptor from the merge_unit to the read_unit
   tagc_desc_t read_desc;
@@ -352,6 +425,58 @@ module axi_tagctrl_top #(
 
   // global flush signals
   logic tagctrl_isolate, tagctrl_isolated, aw_unit_busy, ar_unit_busy, flush_recv;
+  logic flush_unit_busy, flush_unit_line, flush_unit_inflight;
+
+  // posted writes of the W units, see (module.axi_tagctrl_w)
+  logic [NumSlvPorts-1:0] port_posted_pending, port_ar_ready_unit;
+  // error responses of memory (bit 0) and the tag cache (bit 1)
+  logic [NumSlvPorts-1:0][1:0] port_posted_err;
+  axi_pkg::resp_t [NumSlvPorts-1:0] port_posted_resp;
+  logic posted_pending;
+  // posted write tables of the W units and the bytes of the AR bursts
+  logic [NumSlvPorts-1:0][axi_tagctrl_pkg::PostedWrDepth-1:0] port_posted_valid;
+  axi_addr_t [NumSlvPorts-1:0][axi_tagctrl_pkg::PostedWrDepth-1:0] port_posted_first,
+      port_posted_last;
+  axi_addr_t [NumSlvPorts-1:0] ar_first, ar_last;
+  // the AR of the slave port overlaps a posted write and is held, reads are held somewhere
+  logic [NumSlvPorts-1:0] ar_posted_hold, ar_held;
+  logic posted_hold;
+
+  // tag word buffers of the slave ports, see (module.axi_tagctrl_tag_buf)
+  // Tagged write bursts waiting for their tag cache response. Per slave port one in the AX unit,
+  // the FIFO to the W unit, one in the W unit and the posted writes of the W unit.
+  localparam int unsigned MaxTagWr = NumSlvPorts *
+      (Cfg.TagAXFifoDepth + 32'd2 + axi_tagctrl_pkg::PostedWrDepth);
+  typedef logic [$clog2(MaxTagWr+1)-1:0] tag_wr_cnt_t;
+  axi_addr_t [NumSlvPorts-1:0] ar_tag_first, ar_tag_last, aw_tag_first, aw_tag_last;
+  logic [NumSlvPorts-1:0] aw_tagged, tagbuf_hit, tagbuf_fill, tagbuf_r_fill, tagbuf_w_upd;
+  axi_data_t [NumSlvPorts-1:0] tagbuf_data, tagbuf_r_fill_data;
+  axi_data_t [NumSlvPorts-1:0] tagbuf_w_upd_data, tagbuf_w_upd_bit_en;
+  axi_addr_t [NumSlvPorts-1:0] tagbuf_r_fill_word, tagbuf_w_upd_word;
+
+  // atomics, see (module.axi_tagctrl_w)
+  logic [NumSlvPorts-1:0] mem_r_atop, mem_r_ready, atop_mem_r_ready, atop_release;
+  slv_r_chan_t [NumSlvPorts-1:0] atop_r;
+  logic [NumSlvPorts-1:0] atop_r_valid, atop_r_ready;
+  // the atomic of the slave port locks the tag cache line of its tag word, the AW unit of the
+  // slave port has a tag cache descriptor for a line locked by another port
+  logic [NumSlvPorts-1:0] atop_lock, aw_atop_hold;
+  axi_addr_t [NumSlvPorts-1:0] atop_lock_addr;
+  // tagged write bursts of all slave ports which wait for their tag cache response
+  tag_wr_cnt_t tag_wr_cnt_d, tag_wr_cnt_q;
+
+  // AX beats of the slave ports, decoded by the config unit
+  axi_addr_t [NumSlvPorts-1:0] slv_aw_addr, slv_ar_addr;
+  axi_slv_id_t [NumSlvPorts-1:0] slv_aw_id, slv_ar_id;
+  logic [NumSlvPorts-1:0][31:0] slv_aw_user, slv_ar_user;
+
+  // AX beats which target an untagged address region
+  logic [NumSlvPorts-1:0] aw_untagged, ar_untagged;
+
+  // Tag cache way partitions of the AX beats
+  axi_tagctrl_pkg::part_idx_t [NumSlvPorts-1:0] aw_part, ar_part;
+  // Ways the descriptor in the tag lookup must not allocate in
+  way_ind_t part_way_mask, part_lock_d, part_lock_q;
 
   // define address rules from the address ports, propagate it throughout the design
   rule_full_t cached_addr_rule;
@@ -366,9 +491,10 @@ module axi_tagctrl_top #(
       .Cfg          (Cfg),
       .AxiCfg       (AxiCfg),
       .RegWidth     (RegWidth),
+      .NumSlvPorts  (NumSlvPorts),
       .conf_regs_d_t(conf_regs_d_t),
       .conf_regs_q_t(conf_regs_q_t),
-      .desc_t       (tagctrl_desc_t),
+      .desc_t       (tagc_desc_t),
       .rule_full_t  (rule_full_t),
       .set_asso_t   (way_ind_t),
       .addr_full_t  (axi_addr_t),
@@ -389,165 +515,527 @@ module axi_tagctrl_top #(
       .tagctrl_isolated_i(tagctrl_isolated),
       .aw_unit_busy_i    (aw_unit_busy),
       .ar_unit_busy_i    (ar_unit_busy),
+      .flush_unit_busy_i (flush_unit_inflight),
       .flush_desc_recv_i (flush_recv),
       // BIST input
       .bist_res_i        (bist_res),
       .bist_valid_i      (bist_valid),
       // address rules for bypass selection
       .axi_cached_rule_i (cached_addr_rule),
-      .axi_spm_rule_i    ('0)
+      .axi_spm_rule_i    ('0),
+      // tagged and untagged address regions
+      .addr_regions_i    (tagctrl_regs_i.addr_region),
+      .slv_aw_addr_i     (slv_aw_addr),
+      .slv_ar_addr_i     (slv_ar_addr),
+      .aw_untagged_o     (aw_untagged),
+      .ar_untagged_o     (ar_untagged),
+      // way partitions
+      .partitions_i      (tagctrl_regs_i.partition),
+      .slv_aw_id_i       (slv_aw_id),
+      .slv_aw_user_i     (slv_aw_user),
+      .slv_ar_id_i       (slv_ar_id),
+      .slv_ar_user_i     (slv_ar_user),
+      .aw_part_o         (aw_part),
+      .ar_part_o         (ar_part)
   );
 
-  //--------------------------------//
-  // Tag controller R channel Logic //
-  //--------------------------------//
-
-  axi_tagctrl_ax #(
-      .Cfg           (Cfg),
-      .Write         (1'b0),            // connected to the AR channel
-      .tagctrl_desc_t(tagctrl_desc_t),
-      .tagc_desc_t   (tagc_desc_t),
-      .ax_chan_t     (slv_ar_chan_t)
-  ) axi_tag_ctrl_ar (
-      .clk_i,
-      .rst_ni,
-      .ax_chan_slv_i      (to_tagctrl_req.ar),
-      .ax_chan_valid_i    (to_tagctrl_req.ar_valid),
-      .ax_chan_ready_o    (from_tagctrl_resp.ar_ready),
-      .tagc_desc_o        (ax_desc[axi_llc_pkg::ArChanUnit]),
-      .tagc_valid_o       (ax_desc_valid[axi_llc_pkg::ArChanUnit]),
-      .tagc_ready_i       (ax_desc_ready[axi_llc_pkg::ArChanUnit]),
-      .ax_mem_chan_mst_o  (tagctrl_req.ar),
-      .ax_mem_chan_valid_o(tagctrl_req.ar_valid),
-      .ax_mem_chan_ready_i(tagctrl_resp.ar_ready),
-      .tagctrl_desc_o     (tagctrl_ar_desc),
-      .tagctrl_valid_o    (tagctrl_ar_valid),
-      .tagctrl_ready_i    (tagctrl_ar_ready)
-  );
+  // The flush of the config unit starts once every slave port is isolated
+  assign tagctrl_isolated = &port_isolated;
 
-  // FIFO between AR master and R master, there can be DEPTH inflight transactions
-  stream_fifo #(
-      .FALL_THROUGH(1'b1),
-      .DEPTH       (Cfg.TagAXFifoDepth),
-      .T           (tagctrl_desc_t)
-  ) i_stream_fifo_r (
-      .clk_i,
-      .rst_ni,
-      .flush_i   (1'b0),
-      .testmode_i(test_i),
-      .usage_o   (  /*not used*/),
-      .data_i    (tagctrl_ar_desc),
-      .valid_i   (tagctrl_ar_valid),
-      .ready_o   (tagctrl_ar_ready),
-      .data_o    (tagctrl_r_desc),
-      .valid_o   (tagctrl_r_valid),
-      .ready_i   (tagctrl_r_ready)
-  );
+  // Posted writes are acknowledged before they reach memory. An AR which overlaps a posted write
+  // of any slave port is held until the write got its responses, so that no read overtakes an
+  // acknowledged write. While an AR is held no new burst is posted, the held writes drain and
+  // the read is not starved. A flush of the config unit waits for the posted writes as well, the
+  // isolated slave ports already got their B responses.
+  always_comb begin : proc_ar_posted_hold
+    ar_posted_hold = '0;
+    for (int unsigned i = 0; i < NumSlvPorts; i++) begin
+      for (int unsigned p = 0; p < NumSlvPorts; p++) begin
+        for (int unsigned e = 0; e < axi_tagctrl_pkg::PostedWrDepth; e++) begin
+          if (port_posted_valid[p][e] && (ar_first[i] <= port_posted_last[p][e]) &&
+              (ar_last[i] >= port_posted_first[p][e])) begin
+            ar_posted_hold[i] = 1'b1;
+          end
+        end
+      end
+    end
+  end
 
-  axi_tagctrl_r #(
-      .Cfg           (Cfg),
-      .tagctrl_desc_t(tagctrl_desc_t),
-      .tagc_inp_t    (tagc_inp_t),
-      .r_chan_t      (slv_r_chan_t)
-  ) i_axi_tag_ctrl_r (
-      .clk_i,
-      .rst_ni,
-      .tagctrl_desc_i      (tagctrl_r_desc),
-      .tagctrl_desc_valid_i(tagctrl_r_valid),
-      .tagctrl_desc_ready_o(tagctrl_r_ready),
-      .r_chan_mst_i        (tagctrl_resp.r),
-      .r_chan_valid_i      (tagctrl_resp.r_valid),
-      .r_chan_ready_o      (tagctrl_req.r_ready),
-      .tagc_inp_r_i        (tagc_r_inp),
-      .tagc_inp_r_valid_i  (tagc_r_inp_valid),
-      .tagc_inp_r_ready_o  (tagc_r_inp_ready),
-      .r_chan_slv_o        (from_tagctrl_resp.r),
-      .r_chan_slv_valid_o  (from_tagctrl_resp.r_valid),
-      .r_chan_slv_ready_i  (to_tagctrl_req.r_ready)
-  );
+  // An atomic reads its old tag word and writes the new one with two tag cache descriptors. From
+  // the read until the write is issued its tag cache line is locked, the tag cache descriptors of
+  // the AW units of the other slave ports to the line are held. No tag write of another port lands
+  // between the two, later ones queue behind the write of the atomic in the tag cache. The lock
+  // is not taken in the hit miss unit, a held descriptor would block its single lookup stage,
+  // which the write of the atomic still has to pass.
+  always_comb begin : proc_atop_lock
+    aw_atop_hold = '0;
+    for (int unsigned i = 0; i < NumSlvPorts; i++) begin
+      for (int unsigned p = 0; p < NumSlvPorts; p++) begin
+        if ((p != i) && atop_lock[p] &&
+            (tagc_line(port_aw_desc[i].a_x_addr) == tagc_line(atop_lock_addr[p]))) begin
+          aw_atop_hold[i] = 1'b1;
+        end
+      end
+    end
+  end
+
+  assign port_aw_arb_valid = port_aw_valid & ~aw_atop_hold;
+  assign port_aw_ready     = port_aw_arb_ready & ~aw_atop_hold;
+
+  assign posted_hold    = |ar_held;
+  assign posted_pending = |port_posted_pending;
+  assign aw_unit_busy   = posted_pending;
+
+  // Every tagged write burst gets one write response of the tag cache
+  always_comb begin : proc_tag_wr_cnt
+    tag_wr_cnt_d = tag_wr_cnt_q;
+    for (int unsigned i = 0; i < NumSlvPorts; i++) begin
+      if (aw_tagged[i]) begin
+        tag_wr_cnt_d = tag_wr_cnt_d + tag_wr_cnt_t'(1);
+      end
+    end
+    if (tagc_b_chan_valid && tagc_b_chan_ready) begin
+      tag_wr_cnt_d = tag_wr_cnt_d - tag_wr_cnt_t'(1);
+    end
+  end
+
+  `FF(tag_wr_cnt_q, tag_wr_cnt_d, '0, clk_i, rst_ni)
+
+  // a wrapped counter would let the tag word buffers fill with stale tag words
+  // pragma translate_off
+  always_ff @(posedge clk_i) begin : proc_check_tag_wr_cnt
+    if (rst_ni) begin
+      tag_wr_cnt_max :
+      assert (int'(tag_wr_cnt_q) + $countones(aw_tagged) <=
+              MaxTagWr + int'(tagc_b_chan_valid && tagc_b_chan_ready))
+      else $fatal(1, "More tagged writes wait for the tag cache than `MaxTagWr`!");
+    end
+  end
+  // pragma translate_on
+
+  for (genvar i = 0; i < NumSlvPorts; i++) begin : gen_slv_port
+    axi_cut #(
+        // AXI channel structs
+        .aw_chan_t  (slv_aw_chan_t),
+        .w_chan_t   (w_chan_t),
+        .b_chan_t   (slv_b_chan_t),
+        .ar_chan_t  (slv_ar_chan_t),
+        .r_chan_t   (slv_r_chan_t),
+        .req_t  (slv_req_t),
+        .resp_t (slv_resp_t)
+    ) i_axi_cut (
+        .clk_i,
+        .rst_ni,
+        .slv_req_i (slv_req_i[i]),
+        .slv_resp_o(slv_resp_o[i]),
+        .mst_req_o (slv_req_cut[i]),
+        .mst_resp_i(slv_resp_cut[i])
+    );
+
+    // Isolation module before demux to easy flushing,
+    // AXI requests get stalled while flush is active
+    axi_isolate #(
+        .NumPending  (axi_llc_pkg::MaxTrans),
+        .req_t   (slv_req_t),
+        .resp_t  (slv_resp_t)
+    ) i_axi_isolate_flush (
+        .clk_i,
+        .rst_ni,
+        .slv_req_i (slv_req_cut[i]),  // Slave port request
+        .slv_resp_o (slv_resp_cut[i]), // Slave port response
+        .mst_req_o  ( to_tagctrl_req[i]  ),
+        .mst_resp_i ( from_tagctrl_resp[i]  ),
+        .isolate_i  ( tagctrl_isolate   ),
+        .isolated_o ( port_isolated[i]  )
+    );
+
+    assign slv_aw_addr[i] = to_tagctrl_req[i].aw.addr;
+    assign slv_ar_addr[i] = to_tagctrl_req[i].ar.addr;
+    assign slv_aw_id[i]   = to_tagctrl_req[i].aw.id;
+    assign ar_first[i]    = axi_addr_t'(axi_tagctrl_pkg::burst_first_addr(
+        to_tagctrl_req[i].ar.addr, to_tagctrl_req[i].ar.size, to_tagctrl_req[i].ar.len,
+        to_tagctrl_req[i].ar.burst));
+    assign ar_last[i]     = axi_addr_t'(axi_tagctrl_pkg::burst_last_addr(
+        to_tagctrl_req[i].ar.addr, to_tagctrl_req[i].ar.size, to_tagctrl_req[i].ar.len,
+        to_tagctrl_req[i].ar.burst));
+    assign ar_held[i]     = to_tagctrl_req[i].ar_valid & ar_posted_hold[i];
+    assign slv_ar_id[i]   = to_tagctrl_req[i].ar.id;
+    assign slv_aw_user[i] = 32'(to_tagctrl_req[i].aw.user);
+    assign slv_ar_user[i] = 32'(to_tagctrl_req[i].ar.user);
+
+    //--------------------------------//
+    // Tag controller R channel Logic //
+    //--------------------------------//
+
+    axi_tagctrl_ax #(
+        .Cfg           (Cfg),
+        .Write         (1'b0),            // connected to the AR channel
+        .PortIdx       (i),
+        .tagctrl_desc_t(tagctrl_desc_t),
+        .tagc_desc_t   (tagc_desc_t),
+        .ax_chan_t     (slv_ar_chan_t)
+    ) axi_tag_ctrl_ar (
+        .clk_i,
+        .rst_ni,
+        .ax_chan_slv_i      (to_tagctrl_req[i].ar),
+        .ax_chan_valid_i    (to_tagctrl_req[i].ar_valid & ~ar_posted_hold[i]),
+        .ax_chan_ready_o    (port_ar_ready_unit[i]),
+        .untagged_i         (ar_untagged[i]),
+        .part_i             (ar_part[i]),
+        .tagbuf_hit_i       (tagbuf_hit[i]),
+        .tagbuf_data_i      (tagbuf_data[i]),
+        .tagbuf_fill_i      (tagbuf_fill[i]),
+        .tag_word_first_o   (ar_tag_first[i]),
+        .tag_word_last_o    (ar_tag_last[i]),
+        .atop_release_i     (1'b0),
+        .atop_lock_o        (  /*not used*/),
+        .atop_lock_addr_o   (  /*not used*/),
+        .tagc_desc_o        (port_ar_desc[i]),
+        .tagc_valid_o       (port_ar_valid[i]),
+        .tagc_ready_i       (port_ar_ready[i]),
+        .ax_mem_chan_mst_o  (tagctrl_req[i].ar),
+        .ax_mem_chan_valid_o(tagctrl_req[i].ar_valid),
+        .ax_mem_chan_ready_i(tagctrl_resp[i].ar_ready),
+        .tagctrl_desc_o     (tagctrl_ar_desc[i]),
+        .tagctrl_valid_o    (tagctrl_ar_valid[i]),
+        .tagctrl_ready_i    (tagctrl_ar_ready[i])
+    );
 
-  //--------------------------------//
-  // Tag controller W channel Logic //
-  //--------------------------------//
-
-  axi_tagctrl_ax #(
-      .Cfg           (Cfg),
-      .Write         (1'b1),            // connected to the AW channel
-      .tagctrl_desc_t(tagctrl_desc_t),
-      .tagc_desc_t   (tagc_desc_t),
-      .ax_chan_t     (slv_aw_chan_t)
-  ) axi_tag_ctrl_aw (
+    // FIFO between AR master and R master, there can be DEPTH inflight transactions
+    stream_fifo #(
+        .FALL_THROUGH(1'b1),
+        .DEPTH       (Cfg.TagAXFifoDepth),
+        .T           (tagctrl_desc_t)
+    ) i_stream_fifo_r (
+        .clk_i,
+        .rst_ni,
+        .flush_i   (1'b0),
+        .testmode_i(test_i),
+        .usage_o   (  /*not used*/),
+        .data_i    (tagctrl_ar_desc[i]),
+        .valid_i   (tagctrl_ar_valid[i]),
+        .ready_o   (tagctrl_ar_ready[i]),
+        .data_o    (tagctrl_r_desc[i]),
+        .valid_o   (tagctrl_r_valid[i]),
+        .ready_i   (tagctrl_r_ready[i])
+    );
+
+    axi_tagctrl_r #(
+        .Cfg           (Cfg),
+        .tagctrl_desc_t(tagctrl_desc_t),
+        .tagc_inp_t    (tagc_inp_t),
+        .r_chan_t      (slv_r_chan_t)
+    ) i_axi_tag_ctrl_r (
+        .clk_i,
+        .rst_ni,
+        .tagctrl_desc_i      (tagctrl_r_desc[i]),
+        .tagctrl_desc_valid_i(tagctrl_r_valid[i]),
+        .tagctrl_desc_ready_o(tagctrl_r_ready[i]),
+        .r_chan_mst_i        (tagctrl_resp[i].r),
+        .r_chan_valid_i      (tagctrl_resp[i].r_valid & ~mem_r_atop[i]),
+        .r_chan_ready_o      (mem_r_ready[i]),
+        .tagc_inp_r_i        (tagc_r_inp),
+        .tagc_inp_r_valid_i  (port_r_inp_valid[i]),
+        .tagc_inp_r_ready_o  (port_r_inp_ready[i]),
+        .r_chan_slv_o        (from_tagctrl_resp[i].r),
+        .r_chan_slv_valid_o  (from_tagctrl_resp[i].r_valid),
+        .r_chan_slv_ready_i  (to_tagctrl_req[i].r_ready),
+        .tagbuf_fill_o       (tagbuf_r_fill[i]),
+        .tagbuf_fill_word_o  (tagbuf_r_fill_word[i]),
+        .tagbuf_fill_data_o  (tagbuf_r_fill_data[i]),
+        .atop_r_i            (atop_r[i]),
+        .atop_r_valid_i      (atop_r_valid[i]),
+        .atop_r_ready_o      (atop_r_ready[i])
+    );
+
+    // R beats of atomics from memory go to the W unit
+    assign mem_r_atop[i] = atop_id(tagctrl_resp[i].r.id);
+    assign tagctrl_req[i].r_ready = mem_r_atop[i] ? atop_mem_r_ready[i] : mem_r_ready[i];
+
+    //--------------------------------//
+    // Tag controller W channel Logic //
+    //--------------------------------//
+
+    axi_tagctrl_ax #(
+        .Cfg           (Cfg),
+        .Write         (1'b1),            // connected to the AW channel
+        .PortIdx       (i),
+        .tagctrl_desc_t(tagctrl_desc_t),
+        .tagc_desc_t   (tagc_desc_t),
+        .ax_chan_t     (slv_aw_chan_t)
+    ) axi_tag_ctrl_aw (
+        .clk_i,
+        .rst_ni,
+        .ax_chan_slv_i      (to_tagctrl_req[i].aw),
+        .ax_chan_valid_i    (to_tagctrl_req[i].aw_valid),
+        .ax_chan_ready_o    (from_tagctrl_resp[i].aw_ready),
+        .untagged_i         (aw_untagged[i]),
+        .part_i             (aw_part[i]),
+        .tagbuf_hit_i       (1'b0),
+        .tagbuf_data_i      ('0),
+        .tagbuf_fill_i      (1'b0),
+        .tag_word_first_o   (aw_tag_first[i]),
+        .tag_word_last_o    (aw_tag_last[i]),
+        .atop_release_i     (atop_release[i]),
+        .atop_lock_o        (atop_lock[i]),
+        .atop_lock_addr_o   (atop_lock_addr[i]),
+        .tagc_desc_o        (port_aw_desc[i]),
+        .tagc_valid_o       (port_aw_valid[i]),
+        .tagc_ready_i       (port_aw_ready[i]),
+        .ax_mem_chan_mst_o  (tagctrl_req[i].aw),
+        .ax_mem_chan_valid_o(tagctrl_req[i].aw_valid),
+        .ax_mem_chan_ready_i(tagctrl_resp[i].aw_ready),
+        .tagctrl_desc_o     (tagctrl_aw_desc[i]),
+        .tagctrl_valid_o    (tagctrl_aw_valid[i]),
+        .tagctrl_ready_i    (tagctrl_aw_ready[i])
+    );
+
+    // FIFO between AW master and W master, there can be DEPTH inflight transactions
+    stream_fifo #(
+        .FALL_THROUGH(1'b1),
+        .DEPTH       (Cfg.TagAXFifoDepth),
+        .T           (tagctrl_desc_t)
+    ) i_stream_fifo_w (
+        .clk_i,
+        .rst_ni,
+        .flush_i   (1'b0),
+        .testmode_i(test_i),
+        .usage_o   (  /*not used*/),
+        .data_i    (tagctrl_aw_desc[i]),
+        .valid_i   (tagctrl_aw_valid[i]),
+        .ready_o   (tagctrl_aw_ready[i]),
+        .data_o    (tagctrl_w_desc[i]),
+        .valid_o   (tagctrl_w_valid[i]),
+        .ready_i   (tagctrl_w_ready[i])
+    );
+
+    axi_tagctrl_w #(
+        .Cfg           (Cfg),
+        .tagctrl_desc_t(tagctrl_desc_t),
+        .tagc_oup_t    (tagc_oup_t),
+        .w_chan_t      (w_chan_t),
+        .b_chan_t      (slv_b_chan_t),
+        .tagc_inp_t    (tagc_inp_t),
+        .r_chan_t      (slv_r_chan_t)
+    ) i_axi_tag_ctrl_w (
+        .clk_i,
+        .rst_ni,
+        .test_i,
+        .tagctrl_desc_i      (tagctrl_w_desc[i]),
+        .tagctrl_desc_valid_i(tagctrl_w_valid[i]),
+        .tagctrl_desc_ready_o(tagctrl_w_ready[i]),
+        .w_chan_slv_i        (to_tagctrl_req[i].w),
+        .w_chan_slv_valid_i  (to_tagctrl_req[i].w_valid),
+        .w_chan_slv_ready_o  (from_tagctrl_resp[i].w_ready),
+        .b_chan_slv_o        (from_tagctrl_resp[i].b),
+        .b_chan_slv_valid_o  (from_tagctrl_resp[i].b_valid),
+        .b_chan_slv_ready_i  (to_tagctrl_req[i].b_ready),
+        .tagc_oup_o          (port_w_oup[i]),
+        .tagc_oup_valid_o    (port_w_oup_valid[i]),
+        .tagc_oup_ready_i    (port_w_oup_ready[i]),
+        .tagc_resp_i         (tagc_b_chan),
+        .tagc_resp_valid_i   (port_b_chan_valid[i]),
+        .tagc_resp_ready_o   (port_b_chan_ready[i]),
+        .w_chan_mst_o        (tagctrl_req[i].w),
+        .w_chan_mst_valid_o  (tagctrl_req[i].w_valid),
+        .w_chan_mst_ready_i  (tagctrl_resp[i].w_ready),
+        .b_chan_mst_i        (tagctrl_resp[i].b),
+        .b_chan_mst_valid_i  (tagctrl_resp[i].b_valid),
+        .b_chan_mst_ready_o  (tagctrl_req[i].b_ready),
+        .posted_i            (tagctrl_regs_i.posted.en),
+        .posted_hold_i       (posted_hold),
+        .posted_valid_o      (port_posted_valid[i]),
+        .posted_first_o      (port_posted_first[i]),
+        .posted_last_o       (port_posted_last[i]),
+        .posted_pending_o    (port_posted_pending[i]),
+        .posted_err_o        (port_posted_err[i]),
+        .posted_err_resp_o   (port_posted_resp[i]),
+        .tagbuf_upd_o        (tagbuf_w_upd[i]),
+        .tagbuf_upd_word_o   (tagbuf_w_upd_word[i]),
+        .tagbuf_upd_data_o   (tagbuf_w_upd_data[i]),
+        .tagbuf_upd_bit_en_o (tagbuf_w_upd_bit_en[i]),
+        .atop_tag_i          (tagc_r_inp),
+        .atop_tag_valid_i    (port_atop_tag_valid[i]),
+        .atop_tag_ready_o    (port_atop_tag_ready[i]),
+        .atop_r_mst_i        (tagctrl_resp[i].r),
+        .atop_r_mst_valid_i  (tagctrl_resp[i].r_valid & mem_r_atop[i]),
+        .atop_r_mst_ready_o  (atop_mem_r_ready[i]),
+        .atop_r_slv_o        (atop_r[i]),
+        .atop_r_slv_valid_o  (atop_r_valid[i]),
+        .atop_r_slv_ready_i  (atop_r_ready[i]),
+        .atop_release_o      (atop_release[i])
+    );
+
+    assign from_tagctrl_resp[i].ar_ready = port_ar_ready_unit[i] & ~ar_posted_hold[i];
+
+    //-----------------//
+    // Tag word buffer //
+    //-----------------//
+
+    assign aw_tagged[i] = to_tagctrl_req[i].aw_valid & from_tagctrl_resp[i].aw_ready &
+        ~aw_untagged[i];
+
+    if (axi_tagctrl_pkg::TagBufEntries > 0) begin : gen_tag_buf
+      axi_tagctrl_tag_buf #(
+          .Cfg        (Cfg),
+          .NumSlvPorts(NumSlvPorts),
+          .PortIdx    (i),
+          .NumEntries (axi_tagctrl_pkg::TagBufEntries)
+      ) i_tag_buf (
+          .clk_i,
+          .rst_ni,
+          .lookup_valid_i(to_tagctrl_req[i].ar_valid & from_tagctrl_resp[i].ar_ready &
+                          ~ar_untagged[i]),
+          .lookup_first_i(ar_tag_first[i]),
+          .lookup_last_i (ar_tag_last[i]),
+          .lookup_hit_o  (tagbuf_hit[i]),
+          .lookup_data_o (tagbuf_data[i]),
+          .lookup_fill_o (tagbuf_fill[i]),
+          .fill_valid_i  (tagbuf_r_fill[i]),
+          .fill_word_i   (tagbuf_r_fill_word[i]),
+          .fill_data_i   (tagbuf_r_fill_data[i]),
+          .upd_valid_i   (tagbuf_w_upd[i]),
+          .upd_word_i    (tagbuf_w_upd_word[i]),
+          .upd_data_i    (tagbuf_w_upd_data[i]),
+          .upd_bit_en_i  (tagbuf_w_upd_bit_en[i]),
+          .wr_valid_i    (aw_tagged),
+          .wr_first_i    (aw_tag_first),
+          .wr_last_i     (aw_tag_last),
+          .wr_pending_i  (tag_wr_cnt_q != '0)
+      );
+    end else begin : gen_no_tag_buf
+      assign tagbuf_hit[i]  = 1'b0;
+      assign tagbuf_data[i] = '0;
+      assign tagbuf_fill[i] = 1'b0;
+    end
+  end
+
+  // weighted arbitration of the tag cache descriptors of the slave ports, per channel
+  axi_tagctrl_port_arb #(
+      .NumPorts(NumSlvPorts),
+      .Weights (SlvPortWeights),
+      .desc_t  (tagc_desc_t)
+  ) i_ar_port_arb (
       .clk_i,
       .rst_ni,
-      .ax_chan_slv_i      (to_tagctrl_req.aw),
-      .ax_chan_valid_i    (to_tagctrl_req.aw_valid),
-      .ax_chan_ready_o    (from_tagctrl_resp.aw_ready),
-      .tagc_desc_o        (ax_desc[axi_llc_pkg::AwChanUnit]),
-      .tagc_valid_o       (ax_desc_valid[axi_llc_pkg::AwChanUnit]),
-      .tagc_ready_i       (ax_desc_ready[axi_llc_pkg::AwChanUnit]),
-      .ax_mem_chan_mst_o  (tagctrl_req.aw),
-      .ax_mem_chan_valid_o(tagctrl_req.aw_valid),
-      .ax_mem_chan_ready_i(tagctrl_resp.aw_ready),
-      .tagctrl_desc_o     (tagctrl_aw_desc),
-      .tagctrl_valid_o    (tagctrl_aw_valid),
-      .tagctrl_ready_i    (tagctrl_aw_ready)
+      .desc_i (port_ar_desc),
+      .valid_i(port_ar_valid),
+      .ready_o(port_ar_ready),
+      .desc_o (ax_desc[axi_llc_pkg::ArChanUnit]),
+      .valid_o(ax_desc_valid[axi_llc_pkg::ArChanUnit]),
+      .ready_i(ax_desc_ready[axi_llc_pkg::ArChanUnit])
   );
 
-  // FIFO between AW master and W master, there can be DEPTH inflight transactions
-  stream_fifo #(
-      .FALL_THROUGH(1'b1),
-      .DEPTH       (Cfg.TagAXFifoDepth),
-      .T           (tagctrl_desc_t)
-  ) i_stream_fifo_w (
+  axi_tagctrl_port_arb #(
+      .NumPorts(NumSlvPorts),
+      .Weights (SlvPortWeights),
+      .desc_t  (tagc_desc_t)
+  ) i_aw_port_arb (
       .clk_i,
       .rst_ni,
-      .flush_i   (1'b0),
-      .testmode_i(test_i),
-      .usage_o   (  /*not used*/),
-      .data_i    (tagctrl_aw_desc),
-      .valid_i   (tagctrl_aw_valid),
-      .ready_o   (tagctrl_aw_ready),
-      .data_o    (tagctrl_w_desc),
-      .valid_o   (tagctrl_w_valid),
-      .ready_i   (tagctrl_w_ready)
+      .desc_i (port_aw_desc),
+      .valid_i(port_aw_arb_valid),
+      .ready_o(port_aw_arb_ready),
+      .desc_o (ax_desc[axi_llc_pkg::AwChanUnit]),
+      .valid_o(ax_desc_valid[axi_llc_pkg::AwChanUnit]),
+      .ready_i(ax_desc_ready[axi_llc_pkg::AwChanUnit])
   );
 
-  axi_tagctrl_w #(
-      .Cfg           (Cfg),
-      .tagctrl_desc_t(tagctrl_desc_t),
-      .tagc_oup_t    (tagc_oup_t),
-      .w_chan_t      (w_chan_t),
-      .b_chan_t      (slv_b_chan_t)
-  ) i_axi_tag_ctrl_w (
-      .clk_i,
-      .rst_ni,
-      .test_i,
-      .tagctrl_desc_i      (tagctrl_w_desc),
-      .tagctrl_desc_valid_i(tagctrl_w_valid),
-      .tagctrl_desc_ready_o(tagctrl_w_ready),
-      .w_chan_slv_i        (to_tagctrl_req.w),
-      .w_chan_slv_valid_i  (to_tagctrl_req.w_valid),
-      .w_chan_slv_ready_o  (from_tagctrl_resp.w_ready),
-      .b_chan_slv_o        (from_tagctrl_resp.b),
-      .b_chan_slv_valid_o  (from_tagctrl_resp.b_valid),
-      .b_chan_slv_ready_i  (to_tagctrl_req.b_ready),
-      .tagc_oup_o          (tagc_w_oup),
-      .tagc_oup_valid_o    (tagc_w_oup_valid),
-      .tagc_oup_ready_i    (tagc_w_oup_ready),
-      .tagc_resp_i         (tagc_b_chan),
-      .tagc_resp_valid_i   (tagc_b_chan_valid),
-      .tagc_resp_ready_o   (tagc_b_chan_ready),
-      .w_chan_mst_o        (tagctrl_req.w),
-      .w_chan_mst_valid_o  (tagctrl_req.w_valid),
-      .w_chan_mst_ready_i  (tagctrl_resp.w_ready),
-      .b_chan_mst_i        (tagctrl_resp.b),
-      .b_chan_mst_valid_i  (tagctrl_resp.b_valid),
-      .b_chan_mst_ready_o  (tagctrl_req.b_ready)
+  // Tag words and write responses of the tag cache back to the slave port of their descriptor,
+  // old tag words of atomics go to its W unit
+  always_comb begin : proc_tagc_resp_demux
+    port_r_inp_valid = '0;
+    port_atop_tag_valid = '0;
+    if (atop_id(tagc_r_inp.id)) begin
+      port_atop_tag_valid[tagc_port(tagc_r_inp.id)] = tagc_r_inp_valid;
+      tagc_r_inp_ready = port_atop_tag_ready[tagc_port(tagc_r_inp.id)];
+    end else begin
+      port_r_inp_valid[tagc_port(tagc_r_inp.id)] = tagc_r_inp_valid;
+      tagc_r_inp_ready = port_r_inp_ready[tagc_port(tagc_r_inp.id)];
+    end
+    port_b_chan_valid = '0;
+    port_b_chan_valid[tagc_port(tagc_b_chan.id)] = tagc_b_chan_valid;
+    tagc_b_chan_ready = port_b_chan_ready[tagc_port(tagc_b_chan.id)];
+  end
+
+  if (NumSlvPorts == 32'd1) begin : gen_single_w_port
+    assign tagc_w_oup          = port_w_oup[0];
+    assign tagc_w_oup_valid    = port_w_oup_valid[0];
+    assign port_w_oup_ready[0] = tagc_w_oup_ready;
+    assign w_sel_ready         = 1'b1;
+  end else begin : gen_w_port_mux
+    // The write unit takes the tag words in the order of its descriptors, the hit miss unit can
+    // reorder the descriptors of different ports. The port and the number of tag words of each
+    // write descriptor are queued when the write unit takes it, the tag words of the oldest one
+    // are forwarded.
+    typedef struct packed {
+      port_idx_t     port;
+      axi_pkg::len_t len;
+    } w_sel_t;
+
+    w_sel_t w_sel;
+    logic w_sel_full, w_sel_empty, w_sel_pop;
+    axi_pkg::len_t w_beat_d, w_beat_q;
+
+    fifo_v3 #(
+        .FALL_THROUGH(1'b1),
+        .DEPTH       (32'd2),
+        .dtype       (w_sel_t)
+    ) i_w_sel_fifo (
+        .clk_i,
+        .rst_ni,
+        .flush_i   (1'b0),
+        .testmode_i(test_i),
+        .full_o    (w_sel_full),
+        .empty_o   (w_sel_empty),
+        .usage_o   (  /*not used*/),
+        .data_i    (w_sel_t'{port: tagc_port(write_desc.a_x_id), len: write_desc.a_x_len}),
+        .push_i    (write_desc_valid & write_desc_ready),
+        .data_o    (w_sel),
+        .pop_i     (w_sel_pop)
+    );
+
+    assign w_sel_ready = ~w_sel_full;
+    assign w_sel_pop   = tagc_w_oup_valid & tagc_w_oup_ready & (w_beat_q == w_sel.len);
+
+    always_comb begin : proc_w_port_mux
+      tagc_w_oup                   = port_w_oup[w_sel.port];
+      tagc_w_oup_valid             = ~w_sel_empty & port_w_oup_valid[w_sel.port];
+      port_w_oup_ready             = '0;
+      port_w_oup_ready[w_sel.port] = ~w_sel_empty & tagc_w_oup_ready;
+      w_beat_d                     = w_beat_q;
+      if (tagc_w_oup_valid && tagc_w_oup_ready) begin
+        w_beat_d = w_sel_pop ? '0 : w_beat_q + axi_pkg::len_t'(1);
+      end
+    end
+
+    `FF(w_beat_q, w_beat_d, '0, clk_i, rst_ni)
+  end
+
+  // background flush, cleans dirty tag lines while the slave port stays open
+  axi_tagctrl_flush_unit #(
+      .Cfg      (Cfg),
+      .desc_t   (tagc_desc_t),
+      .way_ind_t(way_ind_t)
+  ) i_flush_unit (
+      .clk_i            (clk_i),
+      .rst_ni           (rst_ni),
+      .flush_i          (tagctrl_regs_i.flush),
+      .busy_o           (flush_unit_busy),
+      .line_o           (flush_unit_line),
+      .inflight_o       (flush_unit_inflight),
+      .pause_i          (tagctrl_isolate),
+      .lookup_desc_i    (desc),
+      .lookup_valid_i   ((hit_valid & hit_ready) | (miss_valid & miss_ready)),
+      .desc_o           (ax_desc[axi_tagctrl_pkg::FlushUnit]),
+      .desc_valid_o     (ax_desc_valid[axi_tagctrl_pkg::FlushUnit]),
+      .desc_ready_i     (ax_desc_ready[axi_tagctrl_pkg::FlushUnit]),
+      .flush_desc_recv_i(flush_recv)
   );
 
   // arbitration tree which funnels the flush, read and write descriptors together
   rr_arb_tree #(
-      .NumIn    (32'd3),
+      .NumIn    (32'd4),
       .DataType (tagc_desc_t),
       .AxiVldRdy(1'b1),
       .LockIn   (1'b1)
@@ -578,9 +1066,38 @@ module axi_tagctrl_top #(
       .data_o (spill_desc)
   );
 
-  axi_llc_hit_miss #(
+  // The hit miss unit has a single tag lookup in flight, which belongs to the descriptor it
+  // accepted last. Its partition decides in which ways a miss may allocate. Lookups still hit
+  // in every way. An empty mask of a partition allows all ways.
+  assign part_way_mask = way_ind_t'(tagctrl_regs_i.partition[spill_desc.part].way_mask);
+  assign part_lock_d   = (part_way_mask == '0) ? '0 : ~part_way_mask;
+  `FFLARN(part_lock_q, part_lock_d, spill_valid & spill_ready, '0, clk_i, rst_ni)
+
+  // Per partition hit and miss events of the tag lookups
+  always_comb begin : proc_part_events
+    tagctrl_regs_o = '0;
+    if (hit_valid && hit_ready) begin
+      tagctrl_regs_o.part_hit[desc.part] = 1'b1;
+    end
+    if (miss_valid && miss_ready && !desc.flush) begin
+      tagctrl_regs_o.part_miss[desc.part] = 1'b1;
+    end
+    tagctrl_regs_o.flush_busy = flush_unit_busy;
+    tagctrl_regs_o.flush_line = flush_unit_line;
+    // every error response is counted, also the ones of the same cycle
+    for (int i = NumSlvPorts - 1; i >= 0; i--) begin
+      tagctrl_regs_o.posted_errs = tagctrl_regs_o.posted_errs + 8'(port_posted_err[i][0]) +
+                                   8'(port_posted_err[i][1]);
+      if (|port_posted_err[i]) begin
+        tagctrl_regs_o.posted_err_resp = port_posted_resp[i];
+      end
+    end
+  end
+
+  axi_tagctrl_hit_miss #(
       .Cfg         (Cfg.tagc_cfg),
       .AxiCfg      (AxiCfg),
+      .ReplPolicy  (ReplPolicy),
       .desc_t      (tagc_desc_t),
       .lock_t      (lock_t),
       .cnt_t       (cnt_t),
@@ -598,7 +1115,7 @@ module axi_tagctrl_top #(
       .miss_ready_i  (miss_ready),
       .hit_valid_o   (hit_valid),
       .hit_ready_i   (hit_ready),
-      .spm_lock_i    (1'b0),
+      .spm_lock_i    (part_lock_q),
       .flushed_i     (flushed),
       .w_unlock_i    (w_unlock),
       .w_unlock_req_i(w_unlock_req),
@@ -611,7 +1128,8 @@ module axi_tagctrl_top #(
       .bist_valid_o  (bist_valid)
   );
 
-  axi_llc_evict_unit #(
+  // write back of the dirty blocks of evicted and flushed lines
+  axi_tagctrl_evict_unit #(
       .Cfg      (Cfg.tagc_cfg),
       .AxiCfg   (AxiCfg),
       .desc_t   (tagc_desc_t),
@@ -648,8 +1166,8 @@ module axi_tagctrl_top #(
       .flush_desc_recv_o(flush_recv)
   );
 
-  // plug in refill unit for test
-  axi_llc_refill_unit #(
+  // refill of the missing blocks of a line
+  axi_tagctrl_refill_unit #(
       .Cfg      (Cfg.tagc_cfg),
       .AxiCfg   (AxiCfg),
       .desc_t   (tagc_desc_t),
@@ -700,7 +1218,9 @@ module axi_tagctrl_top #(
       .cnt_down_o    (cnt_down)
   );
 
-  // write unit
+  // write unit, takes a descriptor once the tag word mux can queue its port
+  assign write_desc_ready = write_unit_ready & w_sel_ready;
+
   axi_tagc_write_unit #(
       .Cfg      (Cfg.tagc_cfg),
       .AxiCfg   (AxiCfg),
@@ -714,8 +1234,8 @@ module axi_tagctrl_top #(
       .rst_ni         (rst_ni),
       .test_i         (test_i),
       .desc_i         (write_desc),
-      .desc_valid_i   (write_desc_valid),
-      .desc_ready_o   (write_desc_ready),
+      .desc_valid_i   (write_desc_valid & w_sel_ready),
+      .desc_ready_o   (write_unit_ready),
       .w_chan_slv_i   (tagc_w_oup),
       .w_chan_valid_i (tagc_w_oup_valid),
       .w_chan_ready_o (tagc_w_oup_ready),
@@ -783,8 +1303,13 @@ module axi_tagctrl_top #(
   );
 
   // AXI Mux to multiplex accesses from the tag cache to refill/evict tag cache lines
-  // and from the tracker to read/write to memory
-  // Attention: This unit widens the AXI ID by one!
+  // and from the slave ports to read/write to memory
+  // Attention: This unit widens the AXI ID by `MstIdExtWidth`!
+  assign mem_req[NumSlvPorts-1:0] = tagctrl_req;
+  assign mem_req[NumSlvPorts]     = tagc_req;
+  assign tagctrl_resp             = mem_resp[NumSlvPorts-1:0];
+  assign tagc_resp                = mem_resp[NumSlvPorts];
+
   axi_mux #(
       .SlvAxiIDWidth(AxiCfg.SlvPortIdWidth),
       .slv_aw_chan_t(slv_aw_chan_t),
@@ -800,7 +1325,7 @@ module axi_tagctrl_top #(
       .slv_resp_t   (slv_resp_t),
       .mst_req_t    (mst_req_t),
       .mst_resp_t   (mst_resp_t),
-      .NoSlvPorts   (32'd2),
+      .NoSlvPorts   (NumSlvPorts + 32'd1),
       .MaxWTrans    (axi_llc_pkg::MaxTrans),
       .FallThrough  (1'b0),                   // No registers
       .SpillAw      (1'b0),                   // No registers
@@ -812,47 +1337,11 @@ module axi_tagctrl_top #(
       .clk_i      (clk_i),
       .rst_ni     (rst_ni),
       .test_i     (test_i),
-      .slv_reqs_i ({tagc_req, tagctrl_req}),
-      .slv_resps_o({tagc_resp, tagctrl_resp}),
+      .slv_reqs_i (mem_req),
+      .slv_resps_o(mem_resp),
       .mst_req_o  (mst_req_o),
       .mst_resp_i (mst_resp_i)
   );
-  slv_req_t  slv_req_cut;
-  slv_resp_t slv_resp_cut;
-  // Isolation module before demux to easy flushing,
-  // AXI requests get stalled while flush is active
-  axi_isolate #(
-      .NumPending  (axi_llc_pkg::MaxTrans),
-      .req_t   (slv_req_t),
-      .resp_t  (slv_resp_t)
-  ) i_axi_isolate_flush (
-      .clk_i,
-      .rst_ni,
-      .slv_req_i (slv_req_cut),  // Slave port request
-      .slv_resp_o (slv_resp_cut), // Slave port response
-      .mst_req_o  ( to_tagctrl_req  ),
-      .mst_resp_i ( from_tagctrl_resp  ),
-      .isolate_i  ( tagctrl_isolate   ),
-      .isolated_o ( tagctrl_isolated  )
-  );
-
-  axi_cut #(
-      // AXI channel structs
-      .aw_chan_t  (slv_aw_chan_t),
-      .w_chan_t   (w_chan_t),
-      .b_chan_t   (slv_b_chan_t),
-      .ar_chan_t  (slv_ar_chan_t),
-      .r_chan_t   (slv_r_chan_t),
-      .req_t  (slv_req_t),
-      .resp_t (slv_resp_t)
-  ) i_axi_cut (
-      .clk_i,
-      .rst_ni,
-      .slv_req_i (slv_req_i),
-      .slv_resp_o(slv_resp_o),
-      .mst_req_o (slv_req_cut),
-      .mst_resp_i(slv_resp_cut)
-  );
 
   // pragma translate_off
 `ifndef VERILATOR
@@ -867,6 +1356,9 @@ module axi_tagctrl_top #(
     assert(AxiDataWidth inside {32'd8, 32'd16, 32'd32, 32'd64,
                                                  32'd128, 32'd256, 32'd512, 32'd1028})
     else $fatal(1, "Parameter `AxiDataWidth` has to be inside the AXI4+ATOP specification!");
+    num_posted_errs :
+    assert (2 * NumSlvPorts < 2 ** $bits(tagctrl_regs_o.posted_errs))
+    else $fatal(1, "The posted write errors of all slave ports do not fit `posted_errs`!");
     axi_user_width :
     assert (AxiUserWidth > 32'd0)
     else $fatal(1, "Parameter `AxiUserWidth` has to be > 0!");
@@ -881,49 +1373,49 @@ module axi_tagctrl_top #(
 
     // check the structs against the Cfg
     slv_aw_id :
-    assert ($bits(slv_req_i.aw.id) == AxiCfg.SlvPortIdWidth)
+    assert ($bits(slv_req_i[0].aw.id) == AxiCfg.SlvPortIdWidth)
     else $fatal(1, $sformatf("llc> AXI Slave port, AW ID width not equal to AxiCfg"));
     slv_aw_addr :
-    assert ($bits(slv_req_i.aw.addr) == AxiCfg.AddrWidthFull)
+    assert ($bits(slv_req_i[0].aw.addr) == AxiCfg.AddrWidthFull)
     else $fatal(1, $sformatf("llc> AXI Slave port, AW ADDR width not equal to AxiCfg"));
     slv_ar_id :
-    assert ($bits(slv_req_i.ar.id) == AxiCfg.SlvPortIdWidth)
+    assert ($bits(slv_req_i[0].ar.id) == AxiCfg.SlvPortIdWidth)
     else $fatal(1, $sformatf("llc> AXI Slave port, AW ID width not equal to AxiCfg"));
     slv_ar_addr :
-    assert ($bits(slv_req_i.ar.addr) == AxiCfg.AddrWidthFull)
+    assert ($bits(slv_req_i[0].ar.addr) == AxiCfg.AddrWidthFull)
     else $fatal(1, $sformatf("llc> AXI Slave port, AW ADDR width not equal to AxiCfg"));
     slv_w_data :
-    assert ($bits(slv_req_i.w.data) == AxiCfg.DataWidthFull)
+    assert ($bits(slv_req_i[0].w.data) == AxiCfg.DataWidthFull)
     else $fatal(1, $sformatf("llc> AXI Slave port, W DATA width not equal to AxiCfg"));
     slv_r_data :
-    assert ($bits(slv_resp_o.r.data) == AxiCfg.DataWidthFull)
+    assert ($bits(slv_resp_o[0].r.data) == AxiCfg.DataWidthFull)
     else $fatal(1, $sformatf("llc> AXI Slave port, R DATA width not equal to AxiCfg"));
     // compare the types against the structs
     slv_req_aw :
-    assert ($bits(slv_aw_chan_t) == $bits(slv_req_i.aw))
-    else $fatal(1, $sformatf("llc> AXI Slave port, slv_aw_chan_t and slv_req_i.aw not equal"));
+    assert ($bits(slv_aw_chan_t) == $bits(slv_req_i[0].aw))
+    else $fatal(1, $sformatf("llc> AXI Slave port, slv_aw_chan_t and slv_req_i[0].aw not equal"));
     slv_req_w :
-    assert ($bits(w_chan_t) == $bits(slv_req_i.w))
-    else $fatal(1, $sformatf("llc> AXI Slave port, w_chan_t and slv_req_i.w not equal"));
+    assert ($bits(w_chan_t) == $bits(slv_req_i[0].w))
+    else $fatal(1, $sformatf("llc> AXI Slave port, w_chan_t and slv_req_i[0].w not equal"));
     slv_req_b :
-    assert ($bits(slv_b_chan_t) == $bits(slv_resp_o.b))
-    else $fatal(1, $sformatf("llc> AXI Slave port, slv_b_chan_t and slv_resp_o.b not equal"));
+    assert ($bits(slv_b_chan_t) == $bits(slv_resp_o[0].b))
+    else $fatal(1, $sformatf("llc> AXI Slave port, slv_b_chan_t and slv_resp_o[0].b not equal"));
     slv_req_ar :
-    assert ($bits(slv_ar_chan_t) == $bits(slv_req_i.ar))
-    else $fatal(1, $sformatf("llc> AXI Slave port, slv_ar_chan_t and slv_req_i.ar not equal"));
+    assert ($bits(slv_ar_chan_t) == $bits(slv_req_i[0].ar))
+    else $fatal(1, $sformatf("llc> AXI Slave port, slv_ar_chan_t and slv_req_i[0].ar not equal"));
     slv_req_r :
-    assert ($bits(slv_r_chan_t) == $bits(slv_resp_o.r))
-    else $fatal(1, $sformatf("llc> AXI Slave port, slv_r_chan_t and slv_resp_o.r not equal"));
+    assert ($bits(slv_r_chan_t) == $bits(slv_resp_o[0].r))
+    else $fatal(1, $sformatf("llc> AXI Slave port, slv_r_chan_t and slv_resp_o[0].r not equal"));
     // check the structs against the Cfg
     mst_aw_id :
-    assert ($bits(mst_req_o.aw.id) == AxiCfg.SlvPortIdWidth + 1)
-    else $fatal(1, $sformatf("llc> AXI Master port, AW ID not equal to AxiCfg.SlvPortIdWidth + 1"));
+    assert ($bits(mst_req_o.aw.id) == AxiCfg.SlvPortIdWidth + MstIdExtWidth)
+    else $fatal(1, $sformatf("llc> AXI Master port, AW ID not equal to AxiCfg.SlvPortIdWidth + MstIdExtWidth"));
     mst_aw_addr :
     assert ($bits(mst_req_o.aw.addr) == AxiCfg.AddrWidthFull)
     else $fatal(1, $sformatf("llc> AXI Master port, AW ADDR width not equal to AxiCfg"));
     mst_ar_id :
-    assert ($bits(mst_req_o.ar.id) == AxiCfg.SlvPortIdWidth + 1)
-    else $fatal(1, $sformatf("llc> AXI Master port, AW ID not equal to AxiCfg.SlvPortIdWidth + 1"));
+    assert ($bits(mst_req_o.ar.id) == AxiCfg.SlvPortIdWidth + MstIdExtWidth)
+    else $fatal(1, $sformatf("llc> AXI Master port, AW ID not equal to AxiCfg.SlvPortIdWidth + MstIdExtWidth"));
     mst_ar_addr :
     assert ($bits(mst_req_o.ar.addr) == AxiCfg.AddrWidthFull)
     else $fatal(1, $sformatf("llc> AXI Master port, AW ADDR width not equal to AxiCfg"));
@@ -7,7 +7,49 @@
 
 `include "common_cells/registers.svh"
 
-/// [TODO] Description here
+/// W channel unit of the tag controller.
+///
+/// Forwards the W beats of the burst of each descriptor to memory through a FIFO. The user bit of
+/// every beat is the tag of its capability, it is collected into the tag word of the beat address
+/// together with a bit enable of the written tags. The tag cache write of a tag word is pushed
+/// once the burst moves on to the next tag word or ends, the beat addresses follow the burst type
+/// of the descriptor. Bursts to untagged regions write no tags and clear the user bits towards
+/// memory.
+///
+/// The B response of a burst waits for memory and the tag cache, an error of the tag cache
+/// replaces the response of memory.
+///
+/// ## Posted writes
+///
+/// With `posted_i` set, the B response of a burst is sent once its last W beat and its tag
+/// update are pushed into the W beat and tag FIFOs, which drain without further conditions. The B
+/// responses of memory and tag cache are counted down in the background, a response other than
+/// `OKAY` pulses the bit of its channel in `posted_err_o`. `posted_pending_o` is set while
+/// responses are outstanding.
+/// A burst in non-posted mode waits until all posted responses arrived, so that the responses of
+/// the two modes are never mixed up.
+///
+/// The byte ranges of the posted bursts which wait for responses are kept in a table of
+/// `axi_tagctrl_pkg::PostedWrDepth` entries, `posted_valid_o`, `posted_first_o` and
+/// `posted_last_o`. The top holds the reads which overlap one of them, so that no read overtakes
+/// an acknowledged write. A burst waits while the table is full, and is not posted while
+/// `posted_hold_i` reports held reads, so that the table drains.
+///
+/// ## Atomic transactions
+///
+/// Atomics (ATOPs) are executed by memory, the unit gives them the tag semantics of a capability
+/// store. They are never posted, the B response waits for memory and the tag cache.
+/// * AtomicStore and AtomicLoad compute a new value, which never is a capability. They clear the
+///   tag.
+/// * AtomicSwap writes the tag of its W beats, like a normal write.
+/// * AtomicCompare writes the tag of the swap value, if the old data memory returns equals the
+///   compare value. Otherwise the tag is left as it is. The tag cache write of the burst is held
+///   in the (module.axi_tagctrl_ax) unit until the outcome is known, `atop_release_o`.
+///
+/// Atomics which return data get the old tag word from the tag cache on `atop_tag_i`, the R beats
+/// of memory on `atop_r_mst_i`. The R beats are handed to the (module.axi_tagctrl_r) unit with the
+/// old tag as user bit. Both inputs are buffered, so that they never stall the tag cache or the R
+/// channel of memory, which they share with the reads of the port.
 
 module axi_tagctrl_w #(
     /// Tag Controller parameters configuration struct. This is passed down from
@@ -20,7 +62,11 @@ module axi_tagctrl_w #(
     /// AXI slave port W channel struct definition.
     parameter type w_chan_t = logic,
     /// AXI slave port B channel struct definition.
-    parameter type b_chan_t = logic
+    parameter type b_chan_t = logic,
+    /// Tag Cache R payload type definition.
+    parameter type tagc_inp_t = logic,
+    /// AXI slave port R channel struct definition.
+    parameter type r_chan_t = logic
 ) (
     /// Clock, positive edge triggered.
     input logic clk_i,
@@ -69,18 +115,86 @@ module axi_tagctrl_w #(
     /// AXI B master channel is valid.
     input logic b_chan_mst_valid_i,
     /// AXI B master channel is ready.
-    output logic b_chan_mst_ready_o
+    output logic b_chan_mst_ready_o,
+    /// Posted write mode, sampled when a burst starts.
+    input logic posted_i,
+    /// Reads are held by posted writes, a new burst is not posted.
+    input logic posted_hold_i,
+    /// Entry of the posted write table is valid.
+    output logic [axi_tagctrl_pkg::PostedWrDepth-1:0] posted_valid_o,
+    /// Address of the first byte of the posted burst.
+    output logic [axi_tagctrl_pkg::PostedWrDepth-1:0][Cfg.AxiAddrWidth-1:0] posted_first_o,
+    /// Address of the last byte of the posted burst.
+    output logic [axi_tagctrl_pkg::PostedWrDepth-1:0][Cfg.AxiAddrWidth-1:0] posted_last_o,
+    /// Posted writes still wait for B responses of memory or the tag cache.
+    output logic posted_pending_o,
+    /// A posted write got an error response, bit `0` from memory and bit `1` from the tag cache.
+    /// Each bit pulses once per response.
+    output logic [1:0] posted_err_o,
+    /// Response of the failed posted write, the one of the tag cache if both failed.
+    output axi_pkg::resp_t posted_err_resp_o,
+    /// A tag update is pushed towards the tag cache, for the tag word buffer of the port, see
+    /// (module.axi_tagctrl_tag_buf).
+    output logic tagbuf_upd_o,
+    /// Tag word index of the tag update, relative to `DRAMMemBase`.
+    output logic [Cfg.AxiAddrWidth-1:0] tagbuf_upd_word_o,
+    /// Tag bits of the tag update.
+    output logic [Cfg.AxiDataWidth-1:0] tagbuf_upd_data_o,
+    /// Written tag bits of the tag update.
+    output logic [Cfg.AxiDataWidth-1:0] tagbuf_upd_bit_en_o,
+    /// Old tag word of an atomic from the tag cache.
+    input tagc_inp_t atop_tag_i,
+    /// Old tag word is valid.
+    input logic atop_tag_valid_i,
+    /// Old tag word is ready.
+    output logic atop_tag_ready_o,
+    /// R beat of an atomic from memory.
+    input r_chan_t atop_r_mst_i,
+    /// R beat of an atomic from memory is valid.
+    input logic atop_r_mst_valid_i,
+    /// R beat of an atomic from memory is ready.
+    output logic atop_r_mst_ready_o,
+    /// R beat of an atomic with its old tag, to the (module.axi_tagctrl_r) unit.
+    output r_chan_t atop_r_slv_o,
+    /// R beat of an atomic is valid.
+    output logic atop_r_slv_valid_o,
+    /// R beat of an atomic is ready.
+    input logic atop_r_slv_ready_i,
+    /// The tag update of an AtomicCompare is pushed, its tag cache write can be released.
+    output logic atop_release_o
 );
   typedef logic [Cfg.AxiIdWidth:0] axi_id_mst_t;
   typedef logic [Cfg.AxiDataWidth-1:0] axi_data_t;
   typedef logic [Cfg.AxiAddrWidth-1:0] axi_addr_t;
+  // Outstanding B responses of posted writes
+  typedef logic [7:0] posted_cnt_t;
+  // Posted write table
+  localparam int unsigned PostedDepth = axi_tagctrl_pkg::PostedWrDepth;
+  typedef logic [cf_math_pkg::idx_width(PostedDepth)-1:0] posted_idx_t;
+  typedef logic [cf_math_pkg::idx_width(PostedDepth+1)-1:0] posted_num_t;
+  typedef struct packed {
+    axi_addr_t first;
+    axi_addr_t last;
+    logic      mem_done;   // memory responded
+    logic      tagc_done;  // the tag cache responded, or the burst is untagged
+  } posted_wr_t;
+  // An atomic transfers at most 32 bytes of W data, the compare value of an AtomicCompare is
+  // half of it
+  localparam int unsigned AtopBytes = 32'd32;
+  localparam int unsigned CasBytes = AtopBytes / 2;
+  localparam int unsigned StrbWidth = Cfg.AxiDataWidth / 8;
+  // R beats of an atomic
+  localparam int unsigned AtopRDepth = (AtopBytes > StrbWidth) ? AtopBytes / StrbWidth : 32'd1;
+  // Atomics which can have their old tag word requested, see (module.axi_tagctrl_ax)
+  localparam int unsigned AtopTagDepth = Cfg.TagAXFifoDepth + 32'd2;
   // Registers
   tagctrl_desc_t tagctrl_desc_d, tagctrl_desc_q;
   logic load_desc;
   enum logic [1:0] {
     IDLE,
     SEND_W_CHANNEL,
-    WAIT_B_CHAN_RESP
+    WAIT_B_CHAN_RESP,
+    SEND_POSTED_B
   }
       state_d, state_q;
   // tag cache payload signals
@@ -95,11 +209,34 @@ module axi_tagctrl_w #(
   b_chan_t tagc_b_chan_d, tagc_b_chan_q;
   logic tagc_b_chan_valid_d, tagc_b_chan_valid_q;
   logic en_tagc_b_chan, en_tagc_b_chan_valid;
+  // posted writes
+  logic posted_d, posted_q;
+  posted_cnt_t posted_mem_cnt_d, posted_mem_cnt_q, posted_tagc_cnt_d, posted_tagc_cnt_q;
+  posted_cnt_t posted_mem_cnt_n, posted_tagc_cnt_n;  // with the burst buffered in this cycle
+  logic posted_buffered;  // the last W beat of a posted burst is buffered
+  logic posted_mem_resp, posted_tagc_resp;  // a response of a posted write arrives
+  posted_wr_t [PostedDepth-1:0] posted_wr_d, posted_wr_q;  // oldest entry at the head
+  posted_idx_t posted_head_d, posted_head_q;
+  posted_num_t posted_num_d, posted_num_q;
+  axi_addr_t burst_first_d, burst_first_q, burst_last_d, burst_last_q;  // bytes of the burst
+  logic load_burst;
+  // atomics
+  axi_addr_t atop_addr_d, atop_addr_q;  // address of the atomic
+  axi_addr_t atop_r_addr_d, atop_r_addr_q;  // address of the next R beat of the atomic
+  logic atop_r_done_d, atop_r_done_q;  // all R beats of the atomic are sent
+  logic [CasBytes-1:0][7:0] cas_cmp_d, cas_cmp_q;  // compare value of an AtomicCompare
+  logic cas_tag_d, cas_tag_q;  // tag of the swap value of an AtomicCompare
+  logic cas_match_d, cas_match_q;  // the old data equals the compare value so far
+  logic load_atop, load_atop_r, load_cas;
 
 
   // auxiliary signals
   // Tag index bit (indicates if we are reading from a valid capability or not)
   logic [$clog2(Cfg.AxiDataWidth)-1:0] tag_bit_ind;
+  // Address of the next beat, follows the burst type (FIXED, INCR or WRAP) of the descriptor
+  axi_addr_t next_addr;
+  // The next beat is covered by another tag word
+  logic next_tag_word;
   // tag cache FIFO control signals
   logic tag_fifo_full;  // the FIFO is full
   logic tag_fifo_empty;  // the FIFO is full
@@ -112,26 +249,73 @@ module axi_tagctrl_w #(
   logic w_mst_fifo_empty;  // the FIFO is full
   logic w_mst_fifo_push;  // push data into the FIFO
   logic w_mst_fifo_pop;  // pop data from FIFO if it gets transferred
-  tagc_oup_t w_mst_fifo_data;  // gets assigned to the w channel
-  tagc_oup_t w_mst_fifo_indata;
+  w_chan_t w_mst_fifo_data;  // gets assigned to the w channel
+  w_chan_t w_mst_fifo_indata;
+  // atomics
+  logic is_atop;  // the burst is an atomic
+  logic atop_swap;  // the burst is an AtomicSwap
+  logic atop_cas;  // the burst is an AtomicCompare
+  logic w_tag;  // tag bit written by the W beat
+  axi_addr_t cas_bytes;  // size of the compare value of an AtomicCompare
+  logic [$clog2(Cfg.AxiDataWidth)-1:0] atop_tag_ind;  // tag bit index of the atomic
+  logic atop_old_tag;  // old tag of the atomic
+  logic atop_r_hs;  // an R beat of the atomic is sent
+  logic atop_tag_fifo_empty, atop_tag_fifo_full, atop_tag_fifo_pop;
+  tagc_inp_t atop_tag_fifo_data;
+  logic atop_r_fifo_empty, atop_r_fifo_full, atop_r_fifo_pop;
+  r_chan_t atop_r_fifo_data;
 
   // Decode tag bit index based on the address
   assign tag_bit_ind = tagctrl_desc_q.a_x_addr[$clog2(Cfg.CapSize/8)+:$clog2(Cfg.AxiDataWidth)];
+  assign next_addr = axi_tagctrl_pkg::next_beat_addr(
+      tagctrl_desc_q.a_x_addr,
+      tagctrl_desc_q.a_x_size,
+      tagctrl_desc_q.a_x_len,
+      tagctrl_desc_q.a_x_burst
+  );
+  // only INCR bursts leave the tag word, WRAP bursts fold back inside of it
+  assign next_tag_word = (next_addr >> $clog2(Cfg.AxiDataWidth * Cfg.CapSize / 8)) !=
+      (tagctrl_desc_q.a_x_addr >> $clog2(Cfg.AxiDataWidth * Cfg.CapSize / 8));
 
   // Tag cache output assignments
   assign tagc_oup_valid_o = ~tag_fifo_empty;
   assign tagc_oup_o = tag_fifo_data;
   assign tag_fifo_pop = tagc_oup_valid_o && tagc_oup_ready_i;
 
+  // Atomics, see `axi_pkg::atop_t`
+  assign is_atop = (tagctrl_desc_q.atop[5:4] != axi_pkg::ATOP_NONE);
+  assign atop_swap = (tagctrl_desc_q.atop == axi_pkg::ATOP_ATOMICSWAP);
+  assign atop_cas = (tagctrl_desc_q.atop == axi_pkg::ATOP_ATOMICCMP);
+  assign cas_bytes = ((axi_addr_t'(tagctrl_desc_q.a_x_len) + 1) << tagctrl_desc_q.a_x_size) >> 1;
+  assign atop_tag_ind = atop_addr_q[$clog2(Cfg.CapSize/8)+:$clog2(Cfg.AxiDataWidth)];
+  // atomics which compute a new value never write a capability
+  assign w_tag = w_chan_slv_i.user[0] && (!is_atop || atop_swap);
+  // untagged regions have no tag word in the tag cache
+  assign atop_old_tag = !tagctrl_desc_q.untagged && atop_tag_fifo_data.data[atop_tag_ind];
+
+  // Tag updates in the order they reach the tag cache, the one of an AtomicCompare is pushed after
+  // its address moved on
+  assign tagbuf_upd_o = tag_fifo_push;
+  assign tagbuf_upd_word_o = ((is_atop ? atop_addr_q : tagctrl_desc_q.a_x_addr) - Cfg.DRAMMemBase) >>
+      $clog2(Cfg.tagc_cfg.BlockSize * (Cfg.CapSize / 8));
+  assign tagbuf_upd_data_o = tag_fifo_indata.data;
+  assign tagbuf_upd_bit_en_o = tag_fifo_indata.bit_en;
+
   // FIFO w beats memory assignments
   assign w_mst_fifo_pop = w_chan_mst_ready_i && w_chan_mst_valid_o;
-  assign w_mst_fifo_indata = w_chan_slv_i;
+  always_comb begin : w_mst_fifo_data_ctrl
+    w_mst_fifo_indata = w_chan_slv_i;
+    // untagged regions never carry capabilities
+    if (tagctrl_desc_q.untagged) begin
+      w_mst_fifo_indata.user = '0;
+    end
+  end
   assign w_chan_mst_o = w_mst_fifo_data;
   assign w_chan_mst_valid_o = ~w_mst_fifo_empty;
 
+  assign posted_pending_o = (posted_mem_cnt_q != '0) || (posted_tagc_cnt_q != '0);
+
   always_comb begin : w_chan_ctrl
-    automatic axi_addr_t addr;
-    addr = '0;
     // registers default values
     tagctrl_desc_d = tagctrl_desc_q;
     load_desc = 1'b0;
@@ -159,6 +343,48 @@ module axi_tagctrl_w #(
     en_tagc_b_chan = 1'b0;
     tagc_b_chan_valid_d = tagc_b_chan_valid_q;
     en_tagc_b_chan_valid = 1'b0;
+    b_chan_slv_o = '0;
+    // posted writes
+    posted_d = posted_q;
+    posted_buffered = 1'b0;
+    posted_mem_cnt_d = posted_mem_cnt_q;
+    posted_tagc_cnt_d = posted_tagc_cnt_q;
+    posted_mem_resp = 1'b0;
+    posted_tagc_resp = 1'b0;
+    posted_err_o = '0;
+    posted_err_resp_o = axi_pkg::RESP_OKAY;
+    burst_first_d = burst_first_q;
+    burst_last_d = burst_last_q;
+    load_burst = 1'b0;
+    // atomics
+    atop_addr_d = atop_addr_q;
+    atop_r_done_d = atop_r_done_q;
+    load_atop = 1'b0;
+    load_atop_r = 1'b0;
+    atop_r_slv_valid_o = 1'b0;
+    atop_tag_fifo_pop = 1'b0;
+    atop_release_o = 1'b0;
+
+    // collect the responses of posted writes, overridden below by a non-posted burst, which only
+    // starts once nothing is outstanding
+    b_chan_mst_ready_o = (posted_mem_cnt_q != '0);
+    tagc_resp_ready_o  = (posted_tagc_cnt_q != '0);
+    if (b_chan_mst_valid_i && b_chan_mst_ready_o) begin
+      posted_mem_resp = 1'b1;
+      posted_mem_cnt_d = posted_mem_cnt_q - posted_cnt_t'(1);
+      if (b_chan_mst_i.resp != axi_pkg::RESP_OKAY) begin
+        posted_err_o[0] = 1'b1;
+        posted_err_resp_o = b_chan_mst_i.resp;
+      end
+    end
+    if (tagc_resp_valid_i && tagc_resp_ready_o) begin
+      posted_tagc_resp = 1'b1;
+      posted_tagc_cnt_d = posted_tagc_cnt_q - posted_cnt_t'(1);
+      if (tagc_resp_i.resp != axi_pkg::RESP_OKAY) begin
+        posted_err_o[1] = 1'b1;
+        posted_err_resp_o = tagc_resp_i.resp;
+      end
+    end
 
 
     case (state_q)
@@ -181,24 +407,19 @@ module axi_tagctrl_w #(
         if (w_chan_slv_valid_i) begin
           w_mst_fifo_push = 1'b1;
           // update the address
-          addr = axi_pkg::aligned_addr(
-            tagctrl_desc_q.a_x_addr + axi_pkg::num_bytes(
-              tagctrl_desc_q.a_x_size
-            ),
-            tagctrl_desc_q.a_x_size
-          );
-          tagctrl_desc_d.a_x_addr = addr;
+          tagctrl_desc_d.a_x_addr = next_addr;
           load_desc = 1'b1;
-          // store tag bit
-          tagc_w_data_d = tagc_w_data_q | (w_chan_slv_i.user << tag_bit_ind);
+          // store tag bit, FIXED bursts can write the same capability more than once
+          tagc_w_data_d = (tagc_w_data_q & ~(axi_data_t'(1) << tag_bit_ind)) |
+                          (axi_data_t'(w_tag) << tag_bit_ind);
           store_tagc_data = 1'b1;
           tagc_w_bit_en_d = tagc_w_bit_en_q | (1 << tag_bit_ind);
           store_tagc_bit_en = 1'b1;
           // send a tag store package if this is the last beat or
           // the tag bits surpassed the data witdth (I might remove this in a future to improve performance)
-          if ((tag_bit_ind == (Cfg.AxiDataWidth - 1) && addr[0+:$clog2(
-                  Cfg.CapSize/8
-              )] == 0) || w_chan_slv_i.last) begin
+          // untagged bursts do not write to the tag cache, an AtomicCompare writes once the old data
+          // is known
+          if (!tagctrl_desc_q.untagged && !atop_cas && (next_tag_word || w_chan_slv_i.last)) begin
             if (tag_fifo_full) begin
               // in case the tag write fifo to the tag cache is full we need to wait
               load_desc = 1'b0;
@@ -224,16 +445,26 @@ module axi_tagctrl_w #(
             //w_chan_mst_valid_o = 1'b0;
             w_chan_slv_ready_o = 1'b0;
           end
+          // a posted burst is done once its last beat and tag update are buffered
+          if (posted_q && w_chan_slv_i.last && w_mst_fifo_push) begin
+            posted_buffered = 1'b1;
+            state_d = SEND_POSTED_B;
+          end
         end
-        if (w_chan_mst_o.last && w_mst_fifo_pop) begin
+        if (!posted_q && w_chan_mst_o.last && w_mst_fifo_pop) begin
           state_d = WAIT_B_CHAN_RESP;
           b_chan_mst_ready_o = 1'b1;
-          tagc_resp_ready_o = 1'b1;
-          if (b_chan_slv_ready_i && b_chan_mst_valid_i && tagc_resp_valid_i) begin
+          // untagged bursts do not get a response from the tag cache
+          tagc_resp_ready_o = !tagctrl_desc_q.untagged;
+          // atomics wait for their R beats, an AtomicCompare for its tag update
+          if (!is_atop && b_chan_slv_ready_i && b_chan_mst_valid_i &&
+              (tagc_resp_valid_i || tagctrl_desc_q.untagged)) begin
             state_d = IDLE;
             b_chan_slv_o = b_chan_mst_i;
             b_chan_slv_o.id = tagctrl_desc_q.a_x_id;
-            if (tagc_resp_i.resp != axi_pkg::RESP_OKAY) b_chan_slv_o.resp = tagc_resp_i.resp;
+            if (!tagctrl_desc_q.untagged && (tagc_resp_i.resp != axi_pkg::RESP_OKAY)) begin
+              b_chan_slv_o.resp = tagc_resp_i.resp;
+            end
             b_chan_slv_valid_o = 1'b1;
           end else begin
             if (b_chan_mst_valid_i) begin
@@ -242,7 +473,11 @@ module axi_tagctrl_w #(
               mem_b_chan_valid_d = 1'b1;
               en_mem_b_chan_valid = 1'b1;
             end
-            if (tagc_resp_valid_i) begin
+            if (tagctrl_desc_q.untagged) begin
+              // nothing to wait for from the tag cache, the response stays OKAY
+              tagc_b_chan_valid_d = 1'b1;
+              en_tagc_b_chan_valid = 1'b1;
+            end else if (tagc_resp_valid_i) begin
               tagc_b_chan_d = tagc_resp_i;
               en_tagc_b_chan = 1'b1;
               tagc_b_chan_valid_d = 1'b1;
@@ -266,14 +501,46 @@ module axi_tagctrl_w #(
           tagc_b_chan_valid_d = 1'b1;
           en_tagc_b_chan_valid = 1'b1;
         end
-        if (mem_b_chan_valid_d && tagc_b_chan_valid_d) begin
+        // atomics hand their R beats to the R unit, with the old tag
+        if (is_atop && !atop_r_done_q && !atop_r_fifo_empty &&
+            (tagctrl_desc_q.untagged || !atop_tag_fifo_empty)) begin
+          atop_r_slv_valid_o = 1'b1;
+          // the last R beat of an AtomicCompare pushes its tag update
+          if (atop_cas && !tagctrl_desc_q.untagged && atop_r_fifo_data.last && tag_fifo_full) begin
+            atop_r_slv_valid_o = 1'b0;
+          end
+          if (atop_r_hs && atop_r_fifo_data.last) begin
+            atop_r_done_d = 1'b1;
+            load_atop_r = 1'b1;
+            if (atop_cas && !tagctrl_desc_q.untagged) begin
+              // the swap value is only written if the old data matched
+              tag_fifo_push = 1'b1;
+              tag_fifo_indata.data = axi_data_t'(cas_tag_q) << atop_tag_ind;
+              tag_fifo_indata.strb = 8'b11111111;
+              tag_fifo_indata.bit_en = cas_match_d ? (axi_data_t'(1) << atop_tag_ind) : '0;
+              atop_release_o = 1'b1;
+            end
+          end
+        end
+        if (mem_b_chan_valid_d && tagc_b_chan_valid_d && atop_r_done_d) begin
           state_d = IDLE;
+          // an atomic is done with its old tag word
+          atop_tag_fifo_pop = is_atop && tagctrl_desc_q.atop[axi_pkg::ATOP_R_RESP] &&
+              !tagctrl_desc_q.untagged;
           b_chan_slv_o = mem_b_chan_d;
           b_chan_slv_o.id = tagctrl_desc_q.a_x_id;
           if (tagc_b_chan_d.resp != axi_pkg::RESP_OKAY) b_chan_slv_o.resp = tagc_b_chan_d.resp;
           b_chan_slv_valid_o = 1'b1;
         end
       end
+      SEND_POSTED_B: begin
+        b_chan_slv_o.id = tagctrl_desc_q.a_x_id;
+        b_chan_slv_o.resp = axi_pkg::RESP_OKAY;
+        b_chan_slv_valid_o = 1'b1;
+        if (b_chan_slv_ready_i) begin
+          load_new_desc();
+        end
+      end
       // Go to Idle
       default: begin
         state_d = IDLE;
@@ -285,14 +552,127 @@ module axi_tagctrl_w #(
   function void load_new_desc();
     tagctrl_desc_ready_o = 1'b1;
     state_d = IDLE;
-    // new descriptor at the input
-    if (tagctrl_desc_valid_i) begin
+    // a non-posted burst waits for the outstanding posted responses, a posted burst for a free
+    // entry of the posted write table
+    if (desc_posted() ? (posted_num_q == posted_num_t'(PostedDepth)) : posted_pending_o) begin
+      tagctrl_desc_ready_o = 1'b0;
+    end else if (tagctrl_desc_valid_i) begin
+      // new descriptor at the input
       tagctrl_desc_d = tagctrl_desc_i;
       load_desc = 1'b1;
+      posted_d = desc_posted();
       state_d = SEND_W_CHANNEL;
+      // an atomic without R beats has none to wait for
+      atop_addr_d = tagctrl_desc_i.a_x_addr;
+      atop_r_done_d = !tagctrl_desc_i.atop[axi_pkg::ATOP_R_RESP];
+      load_atop = 1'b1;
+      load_atop_r = 1'b1;
+      burst_first_d = axi_addr_t'(axi_tagctrl_pkg::burst_first_addr(
+          tagctrl_desc_i.a_x_addr, tagctrl_desc_i.a_x_size, tagctrl_desc_i.a_x_len,
+          tagctrl_desc_i.a_x_burst));
+      burst_last_d = axi_addr_t'(axi_tagctrl_pkg::burst_last_addr(
+          tagctrl_desc_i.a_x_addr, tagctrl_desc_i.a_x_size, tagctrl_desc_i.a_x_len,
+          tagctrl_desc_i.a_x_burst));
+      load_burst = 1'b1;
     end
   endfunction : load_new_desc
 
+  // atomics are never posted, neither are bursts while reads wait for posted writes
+  function automatic logic desc_posted();
+    return posted_i && !posted_hold_i && (tagctrl_desc_i.atop[5:4] == axi_pkg::ATOP_NONE);
+  endfunction : desc_posted
+
+  // R beats of atomics to the R unit, with the old tag as user bit
+  assign atop_r_hs = atop_r_slv_valid_o && atop_r_slv_ready_i;
+  assign atop_r_fifo_pop = atop_r_hs;
+  always_comb begin : atop_r_ctrl
+    atop_r_slv_o = atop_r_fifo_data;
+    atop_r_slv_o.id = tagctrl_desc_q.a_x_id;
+    atop_r_slv_o.user = atop_old_tag;
+  end
+
+  // Compare value and swap tag of an AtomicCompare, from the W beats. The compare value lies at the
+  // address of the atomic, the swap value in the other half of the W data.
+  always_comb begin : cas_ctrl
+    automatic axi_addr_t byte_addr;
+    cas_cmp_d = cas_cmp_q;
+    cas_tag_d = cas_tag_q;
+    cas_match_d = cas_match_q;
+    atop_r_addr_d = atop_r_addr_q;
+    load_cas = 1'b0;
+    if (load_atop) begin
+      cas_match_d = 1'b1;
+      atop_r_addr_d = tagctrl_desc_i.a_x_addr;
+      load_cas = 1'b1;
+    end else if (atop_cas && w_chan_slv_valid_i && w_chan_slv_ready_o) begin
+      for (int unsigned i = 0; i < StrbWidth; i++) begin
+        byte_addr = axi_addr_t'(tagctrl_desc_q.a_x_addr & ~axi_addr_t'(StrbWidth - 1)) +
+            axi_addr_t'(i);
+        if (w_chan_slv_i.strb[i]) begin
+          if ((byte_addr - atop_addr_q) < cas_bytes) begin
+            cas_cmp_d[(byte_addr-atop_addr_q)%CasBytes] = w_chan_slv_i.data[8*i+:8];
+          end else begin
+            cas_tag_d = w_chan_slv_i.user[0];
+          end
+        end
+      end
+      load_cas = 1'b1;
+    end else if (atop_cas && atop_r_hs) begin
+      // the R beats hold the old data of the compare value, starting at the address of the atomic
+      for (int unsigned i = 0; i < StrbWidth; i++) begin
+        byte_addr = axi_addr_t'(atop_r_addr_q & ~axi_addr_t'(StrbWidth - 1)) + axi_addr_t'(i);
+        if (((byte_addr - atop_addr_q) < cas_bytes) &&
+            (atop_r_fifo_data.data[8*i+:8] != cas_cmp_q[(byte_addr-atop_addr_q)%CasBytes])) begin
+          cas_match_d = 1'b0;
+        end
+      end
+      atop_r_addr_d = (atop_r_addr_q & ~axi_addr_t'(StrbWidth - 1)) + axi_addr_t'(StrbWidth);
+      load_cas = 1'b1;
+    end
+  end
+
+  // FIFO holds the old tag words of atomics, one for every atomic with R beats the AW unit took
+  fifo_v3 #(
+      .FALL_THROUGH(1'b0),
+      .DEPTH       (AtopTagDepth),
+      .dtype       (tagc_inp_t)
+  ) i_atop_tag_fifo (
+      .clk_i     (clk_i),
+      .rst_ni    (rst_ni),
+      .flush_i   ('0),
+      .testmode_i(test_i),
+      .full_o    (atop_tag_fifo_full),
+      .empty_o   (atop_tag_fifo_empty),
+      .usage_o   (  /* not used */),
+      .data_i    (atop_tag_i),
+      .push_i    (atop_tag_valid_i && !atop_tag_fifo_full),
+      .data_o    (atop_tag_fifo_data),
+      .pop_i     (atop_tag_fifo_pop)
+  );
+
+  assign atop_tag_ready_o = !atop_tag_fifo_full;
+
+  // FIFO holds the R beats of the atomic, memory executes it once it has all W beats
+  fifo_v3 #(
+      .FALL_THROUGH(1'b0),
+      .DEPTH       (AtopRDepth),
+      .dtype       (r_chan_t)
+  ) i_atop_r_fifo (
+      .clk_i     (clk_i),
+      .rst_ni    (rst_ni),
+      .flush_i   ('0),
+      .testmode_i(test_i),
+      .full_o    (atop_r_fifo_full),
+      .empty_o   (atop_r_fifo_empty),
+      .usage_o   (  /* not used */),
+      .data_i    (atop_r_mst_i),
+      .push_i    (atop_r_mst_valid_i && !atop_r_fifo_full),
+      .data_o    (atop_r_fifo_data),
+      .pop_i     (atop_r_fifo_pop)
+  );
+
+  assign atop_r_mst_ready_o = !atop_r_fifo_full;
+
 
   // FIFO holds W beats to send to memory
   fifo_v3 #(
@@ -338,6 +718,69 @@ module axi_tagctrl_w #(
       .pop_i     (tag_fifo_pop)       // pop head from queue
   );
 
+  // Outstanding responses of posted writes, untagged bursts get no response of the tag cache
+  always_comb begin : proc_posted_cnt
+    posted_mem_cnt_n  = posted_mem_cnt_d;
+    posted_tagc_cnt_n = posted_tagc_cnt_d;
+    if (posted_buffered) begin
+      posted_mem_cnt_n = posted_mem_cnt_d + posted_cnt_t'(1);
+      if (!tagctrl_desc_q.untagged) begin
+        posted_tagc_cnt_n = posted_tagc_cnt_d + posted_cnt_t'(1);
+      end
+    end
+  end
+
+  // Posted write table. The responses of memory and the tag cache arrive in order, each completes
+  // the oldest posted write which waits for it. Completed writes leave the table in order.
+  always_comb begin : proc_posted_wr
+    automatic logic mem_found = 1'b0;
+    automatic logic tagc_found = 1'b0;
+    automatic posted_idx_t idx;
+    posted_wr_d   = posted_wr_q;
+    posted_head_d = posted_head_q;
+    posted_num_d  = posted_num_q;
+    for (int unsigned k = 0; k < PostedDepth; k++) begin
+      idx = posted_idx_t'((int'(posted_head_q) + k) % PostedDepth);
+      if (k < posted_num_q) begin
+        if (posted_mem_resp && !mem_found && !posted_wr_q[idx].mem_done) begin
+          posted_wr_d[idx].mem_done = 1'b1;
+          mem_found = 1'b1;
+        end
+        if (posted_tagc_resp && !tagc_found && !posted_wr_q[idx].tagc_done) begin
+          posted_wr_d[idx].tagc_done = 1'b1;
+          tagc_found = 1'b1;
+        end
+      end
+    end
+    for (int unsigned k = 0; k < PostedDepth; k++) begin
+      if ((posted_num_d != '0) && posted_wr_d[posted_head_d].mem_done &&
+          posted_wr_d[posted_head_d].tagc_done) begin
+        posted_head_d = (posted_head_d == posted_idx_t'(PostedDepth - 1)) ? '0 :
+                                                                              posted_head_d + 1;
+        posted_num_d  = posted_num_d - posted_num_t'(1);
+      end
+    end
+    if (posted_buffered) begin
+      idx = posted_idx_t'((int'(posted_head_d) + int'(posted_num_d)) % PostedDepth);
+      posted_wr_d[idx] = posted_wr_t'{
+          first:     burst_first_q,
+          last:      burst_last_q,
+          mem_done:  1'b0,
+          tagc_done: tagctrl_desc_q.untagged
+      };
+      posted_num_d = posted_num_d + posted_num_t'(1);
+    end
+  end
+
+  always_comb begin : proc_posted_table
+    for (int unsigned k = 0; k < PostedDepth; k++) begin
+      posted_valid_o[k] = ((int'(k) + PostedDepth - int'(posted_head_q)) % PostedDepth) <
+                          int'(posted_num_q);
+      posted_first_o[k] = posted_wr_q[k].first;
+      posted_last_o[k]  = posted_wr_q[k].last;
+    end
+  end
+
   // Registers Flip Flops
   `FFLARN(state_q, state_d, '1, IDLE, clk_i, rst_ni)
   `FFLARN(tagctrl_desc_q, tagctrl_desc_d, load_desc, '0, clk_i, rst_ni)
@@ -347,5 +790,19 @@ module axi_tagctrl_w #(
   `FFLARN(mem_b_chan_valid_q, mem_b_chan_valid_d, en_mem_b_chan_valid, '0, clk_i, rst_ni)
   `FFLARN(tagc_b_chan_q, tagc_b_chan_d, en_tagc_b_chan, '0, clk_i, rst_ni)
   `FFLARN(tagc_b_chan_valid_q, tagc_b_chan_valid_d, en_tagc_b_chan_valid, '0, clk_i, rst_ni)
+  `FFLARN(posted_q, posted_d, load_desc, 1'b0, clk_i, rst_ni)
+  `FF(posted_mem_cnt_q, posted_mem_cnt_n, '0, clk_i, rst_ni)
+  `FF(posted_tagc_cnt_q, posted_tagc_cnt_n, '0, clk_i, rst_ni)
+  `FF(posted_wr_q, posted_wr_d, '0, clk_i, rst_ni)
+  `FF(posted_head_q, posted_head_d, '0, clk_i, rst_ni)
+  `FF(posted_num_q, posted_num_d, '0, clk_i, rst_ni)
+  `FFLARN(burst_first_q, burst_first_d, load_burst, '0, clk_i, rst_ni)
+  `FFLARN(burst_last_q, burst_last_d, load_burst, '0, clk_i, rst_ni)
+  `FFLARN(atop_addr_q, atop_addr_d, load_atop, '0, clk_i, rst_ni)
+  `FFLARN(atop_r_done_q, atop_r_done_d, load_atop_r, 1'b1, clk_i, rst_ni)
+  `FFLARN(atop_r_addr_q, atop_r_addr_d, load_cas, '0, clk_i, rst_ni)
+  `FFLARN(cas_cmp_q, cas_cmp_d, load_cas, '0, clk_i, rst_ni)
+  `FFLARN(cas_tag_q, cas_tag_d, load_cas, 1'b0, clk_i, rst_ni)
+  `FFLARN(cas_match_q, cas_match_d, load_cas, 1'b1, clk_i, rst_ni)
 
 endmodule
@@ -16,6 +16,12 @@
 // Description: Manages AXI transactions
 //              Supports all burst accesses but only on aligned addresses and with full data width.
 //              Assertions should guide you if there is something unsupported happening.
+//              Atomics (ATOPs) are executed on the naturally aligned 32 byte window around their
+//              address, little endian only: the W beats are collected, the window is read,
+//              modified and written back, then the old data is returned if the ATOP has an R
+//              response.
+//              Writes which start at `err_addr_i` get a SLVERR response while `err_en_i` is set,
+//              their data is written nevertheless.
 //
 module axi2mem #(
     parameter int unsigned AXI_ID_WIDTH   = 10,
@@ -33,7 +39,9 @@ module axi2mem #(
     output logic         [  AXI_USER_WIDTH-1:0] user_o,
     output logic         [  AXI_DATA_WIDTH-1:0] data_o,
     input  logic         [  AXI_USER_WIDTH-1:0] user_i,
-    input  logic         [  AXI_DATA_WIDTH-1:0] data_i
+    input  logic         [  AXI_DATA_WIDTH-1:0] data_i,
+    input  logic                                err_en_i,   // inject write errors
+    input  logic         [  AXI_ADDR_WIDTH-1:0] err_addr_i  // start address of failing writes
 );
 
   // AXI has the following rules governing the use of bursts:
@@ -47,6 +55,11 @@ module axi2mem #(
   } axi_burst_t;
 
   localparam LOG_NR_BYTES = $clog2(AXI_DATA_WIDTH / 8);
+  localparam int unsigned NR_BYTES = AXI_DATA_WIDTH / 8;
+  // an atomic transfers at most 32 bytes of W data
+  localparam int unsigned ATOP_BYTES = 32;
+  localparam int unsigned ATOP_WORDS = (ATOP_BYTES > NR_BYTES) ? ATOP_BYTES / NR_BYTES : 1;
+  localparam int unsigned ATOP_WIN_BYTES = ATOP_WORDS * NR_BYTES;
 
   typedef struct packed {
     logic [AXI_ID_WIDTH-1:0]   id;
@@ -57,33 +70,39 @@ module axi2mem #(
   } ax_req_t;
 
   // Registers
-  enum logic [2:0] {
+  enum logic [3:0] {
     IDLE,
     READ,
     WAIT_WVALID,
     WRITE,
-    SEND_B
+    SEND_B,
+    ATOP_W,
+    ATOP_READ,
+    ATOP_WRITE,
+    ATOP_R
   }
       state_d, state_q;
   ax_req_t ax_req_d, ax_req_q;
   logic [AXI_ADDR_WIDTH-1:0] req_addr_d, req_addr_q;
   logic [7:0] cnt_d, cnt_q;
   logic load_state, load_ax_req, load_req_addr, load_cnt;
+  // atomics
+  axi_pkg::atop_t atop_d, atop_q;
+  logic [ATOP_WIN_BYTES-1:0][7:0] atop_wbuf_d, atop_wbuf_q;  // W data of the window
+  logic [ATOP_WIN_BYTES-1:0][7:0] atop_obuf_d, atop_obuf_q;  // old data of the window
+  logic [ATOP_WIN_BYTES-1:0][7:0] atop_new;  // new data of the window
+  logic [ATOP_WIN_BYTES-1:0] atop_be;  // written bytes of the window
+  logic [AXI_ADDR_WIDTH-1:0] atop_win;  // start of the window
+  logic [AXI_ADDR_WIDTH-1:0] atop_beat_addr;  // word address of the current W beat
+  int unsigned atop_bytes;  // W data bytes of the atomic
+  int unsigned atop_r_beats;  // R beats of the atomic
+  logic load_atop, load_atop_wbuf, load_atop_obuf;
 
   function automatic logic [AXI_ADDR_WIDTH-1:0] get_wrap_boundary(
       input logic [AXI_ADDR_WIDTH-1:0] unaligned_address, input logic [7:0] len);
-    logic [AXI_ADDR_WIDTH-1:0] warp_address = '0;
-    //  for wrapping transfers ax_len can only be of size 1, 3, 7 or 15
-    if (len == 4'b1)
-      warp_address[AXI_ADDR_WIDTH-1:1+LOG_NR_BYTES] = unaligned_address[AXI_ADDR_WIDTH-1:1+LOG_NR_BYTES];
-    else if (len == 4'b11)
-      warp_address[AXI_ADDR_WIDTH-1:2+LOG_NR_BYTES] = unaligned_address[AXI_ADDR_WIDTH-1:2+LOG_NR_BYTES];
-    else if (len == 4'b111)
-      warp_address[AXI_ADDR_WIDTH-1:3+LOG_NR_BYTES] = unaligned_address[AXI_ADDR_WIDTH-3:2+LOG_NR_BYTES];
-    else if (len == 4'b1111)
-      warp_address[AXI_ADDR_WIDTH-1:4+LOG_NR_BYTES] = unaligned_address[AXI_ADDR_WIDTH-3:4+LOG_NR_BYTES];
-
-    return warp_address;
+    //  for wrapping transfers ax_len can only be of size 1, 3, 7 or 15, the wrap region is
+    //  aligned to its size
+    return unaligned_address & ~((AXI_ADDR_WIDTH'(len) + 1) * NR_BYTES - 1);
   endfunction
 
   logic [AXI_ADDR_WIDTH-1:0] aligned_address;
@@ -91,6 +110,74 @@ module axi2mem #(
   logic [AXI_ADDR_WIDTH-1:0] upper_wrap_boundary;
   logic [AXI_ADDR_WIDTH-1:0] cons_addr;
 
+  // Window, W beat addresses and result of an atomic
+  always_comb begin : proc_atop
+    automatic int unsigned off, n, half, sh;
+    automatic logic [63:0] old_val, op_val, res_val;
+    automatic logic cmp_eq;
+    atop_win   = ax_req_q.addr & ~AXI_ADDR_WIDTH'(ATOP_WIN_BYTES - 1);
+    atop_bytes = (int'(ax_req_q.len) + 1) << ax_req_q.size;
+    // the W beats wrap inside the naturally aligned data of the atomic
+    if (atop_bytes <= NR_BYTES) begin
+      atop_beat_addr = {ax_req_q.addr[AXI_ADDR_WIDTH-1:LOG_NR_BYTES], {{LOG_NR_BYTES} {1'b0}}};
+    end else begin
+      atop_beat_addr = (ax_req_q.addr & ~AXI_ADDR_WIDTH'(atop_bytes - 1)) +
+          AXI_ADDR_WIDTH'((((ax_req_q.addr % atop_bytes) / NR_BYTES + cnt_q) %
+                           (atop_bytes / NR_BYTES)) * NR_BYTES);
+    end
+
+    off = int'(ax_req_q.addr - atop_win);
+    n = 1 << ax_req_q.size;
+    half = atop_bytes / 2;
+    atop_new = atop_obuf_q;
+    atop_be = '0;
+    atop_r_beats = ax_req_q.len + 1;
+    if (atop_q == axi_pkg::ATOP_ATOMICCMP) begin
+      // the compare value lies at the address, the swap value in the other half of the data
+      cmp_eq = 1'b1;
+      for (int unsigned i = 0; i < ATOP_WIN_BYTES; i++) begin
+        if ((i < half) && (atop_obuf_q[off+i] != atop_wbuf_q[off+i])) cmp_eq = 1'b0;
+      end
+      for (int unsigned i = 0; i < ATOP_WIN_BYTES; i++) begin
+        if (cmp_eq && (i < half)) begin
+          atop_new[off+i] = atop_wbuf_q[(off^half)+i];
+          atop_be[off+i]  = 1'b1;
+        end
+      end
+      atop_r_beats = (half > NR_BYTES) ? half / NR_BYTES : 1;
+    end else begin
+      old_val = '0;
+      op_val  = '0;
+      for (int unsigned i = 0; i < 8; i++) begin
+        if ((i < n) && (off + i < ATOP_WIN_BYTES)) begin
+          old_val[8*i+:8] = atop_obuf_q[off+i];
+          op_val[8*i+:8]  = atop_wbuf_q[off+i];
+        end
+      end
+      // compare the values in their most significant bits
+      sh = 64 - 8 * n;
+      res_val = op_val;
+      if (atop_q != axi_pkg::ATOP_ATOMICSWAP) begin
+        unique case (atop_q[2:0])
+          axi_pkg::ATOP_ADD:  res_val = old_val + op_val;
+          axi_pkg::ATOP_CLR:  res_val = old_val & ~op_val;
+          axi_pkg::ATOP_EOR:  res_val = old_val ^ op_val;
+          axi_pkg::ATOP_SET:  res_val = old_val | op_val;
+          axi_pkg::ATOP_SMAX: res_val = ($signed(old_val << sh) > $signed(op_val << sh)) ? old_val : op_val;
+          axi_pkg::ATOP_SMIN: res_val = ($signed(old_val << sh) < $signed(op_val << sh)) ? old_val : op_val;
+          axi_pkg::ATOP_UMAX: res_val = ((old_val << sh) > (op_val << sh)) ? old_val : op_val;
+          default:            res_val = ((old_val << sh) < (op_val << sh)) ? old_val : op_val;
+        endcase
+      end
+      for (int unsigned i = 0; i < 8; i++) begin
+        if ((i < n) && (off + i < ATOP_WIN_BYTES)) begin
+          atop_new[off+i] = res_val[8*i+:8];
+          atop_be[off+i]  = 1'b1;
+        end
+      end
+    end
+  end
+
   always_comb begin
     // address generation
     aligned_address     = {ax_req_q.addr[AXI_ADDR_WIDTH-1:LOG_NR_BYTES], {{LOG_NR_BYTES} {1'b0}}};
@@ -110,6 +197,12 @@ module axi2mem #(
     load_ax_req         = 1'b0;
     load_req_addr       = 1'b0;
     load_cnt            = 1'b0;
+    atop_d              = atop_q;
+    atop_wbuf_d         = atop_wbuf_q;
+    atop_obuf_d         = atop_obuf_q;
+    load_atop           = 1'b0;
+    load_atop_wbuf      = 1'b0;
+    load_atop_obuf      = 1'b0;
     // Memory default assignments
     data_o              = slave.w_data;
     user_o              = slave.w_user;
@@ -160,6 +253,21 @@ module axi2mem #(
           cnt_d = 1;
           load_cnt = 1'b1;
           // ------------
+          // Atomic
+          // ------------
+        end else if (slave.aw_valid && (slave.aw_atop[5:4] != axi_pkg::ATOP_NONE)) begin
+          slave.aw_ready = 1'b1;
+          ax_req_d = {slave.aw_id, slave.aw_addr, slave.aw_len, slave.aw_size, slave.aw_burst};
+          load_ax_req = 1'b1;
+          atop_d = slave.aw_atop;
+          load_atop = 1'b1;
+          atop_wbuf_d = '0;
+          load_atop_wbuf = 1'b1;
+          cnt_d = 0;
+          load_cnt = 1'b1;
+          state_d = ATOP_W;
+          load_state = 1'b1;
+          // ------------
           // Write
           // ------------
         end else if (slave.aw_valid) begin
@@ -205,14 +313,12 @@ module axi2mem #(
           // ----------------------------
           // handle the correct burst type
           case (ax_req_q.burst)
-            FIXED, INCR: addr_o = cons_addr;
+            FIXED: addr_o = aligned_address;
+            INCR:  addr_o = cons_addr;
             WRAP: begin
-              // check if the address reached warp boundary
-              if (cons_addr == upper_wrap_boundary) begin
-                addr_o = wrap_boundary;
-                // address warped beyond boundary
-              end else if (cons_addr > upper_wrap_boundary) begin
-                addr_o = ax_req_q.addr + ((cnt_q - ax_req_q.len) << LOG_NR_BYTES);
+              // fold the address back once it reached the upper wrap boundary
+              if (cons_addr >= upper_wrap_boundary) begin
+                addr_o = cons_addr - (upper_wrap_boundary - wrap_boundary);
                 // we are still in the incremental regime
               end else begin
                 addr_o = cons_addr;
@@ -253,14 +359,12 @@ module axi2mem #(
           // handle the correct burst type
           case (ax_req_q.burst)
 
-            FIXED, INCR: addr_o = cons_addr;
+            FIXED: addr_o = aligned_address;
+            INCR:  addr_o = cons_addr;
             WRAP: begin
-              // check if the address reached warp boundary
-              if (cons_addr == upper_wrap_boundary) begin
-                addr_o = wrap_boundary;
-                // address warped beyond boundary
-              end else if (cons_addr > upper_wrap_boundary) begin
-                addr_o = ax_req_q.addr + ((cnt_q - ax_req_q.len) << LOG_NR_BYTES);
+              // fold the address back once it reached the upper wrap boundary
+              if (cons_addr >= upper_wrap_boundary) begin
+                addr_o = cons_addr - (upper_wrap_boundary - wrap_boundary);
                 // we are still in the incremental regime
               end else begin
                 addr_o = cons_addr;
@@ -285,6 +389,8 @@ module axi2mem #(
       SEND_B: begin
         slave.b_valid = 1'b1;
         slave.b_id    = ax_req_q.id;
+        slave.b_resp  = (err_en_i && (ax_req_q.addr == err_addr_i)) ? axi_pkg::RESP_SLVERR :
+                                                                     axi_pkg::RESP_OKAY;
         if (slave.b_ready) begin
           state_d = IDLE;
           load_state = 1'b1;
@@ -311,6 +417,77 @@ module axi2mem #(
           load_state = 1'b1;
         end
       end
+      // ~> collect the W beats of the atomic
+      ATOP_W: begin
+        slave.w_ready = 1'b1;
+        if (slave.w_valid) begin
+          for (int unsigned i = 0; i < NR_BYTES; i++) begin
+            if (slave.w_strb[i]) begin
+              atop_wbuf_d[int'(atop_beat_addr-atop_win)+i] = slave.w_data[8*i+:8];
+            end
+          end
+          load_atop_wbuf = 1'b1;
+          cnt_d = cnt_q + 1;
+          load_cnt = 1'b1;
+          if (slave.w_last) begin
+            cnt_d = 0;
+            state_d = ATOP_READ;
+            load_state = 1'b1;
+          end
+        end
+      end
+      // ~> read the window, the data arrives a cycle after the request
+      ATOP_READ: begin
+        if (cnt_q < ATOP_WORDS) begin
+          req_o  = 1'b1;
+          addr_o = atop_win + (cnt_q << LOG_NR_BYTES);
+        end
+        if (cnt_q > 0) begin
+          atop_obuf_d[(cnt_q-1)*NR_BYTES+:NR_BYTES] = data_i;
+          load_atop_obuf = 1'b1;
+        end
+        cnt_d = cnt_q + 1;
+        load_cnt = 1'b1;
+        if (cnt_q == ATOP_WORDS) begin
+          cnt_d = 0;
+          state_d = ATOP_WRITE;
+          load_state = 1'b1;
+        end
+      end
+      // ~> write back the window
+      ATOP_WRITE: begin
+        req_o  = 1'b1;
+        we_o   = 1'b1;
+        addr_o = atop_win + (cnt_q << LOG_NR_BYTES);
+        data_o = atop_new[cnt_q*NR_BYTES+:NR_BYTES];
+        be_o   = atop_be[cnt_q*NR_BYTES+:NR_BYTES];
+        user_o = '0;
+        cnt_d = cnt_q + 1;
+        load_cnt = 1'b1;
+        if (cnt_q == ATOP_WORDS - 1) begin
+          cnt_d = 0;
+          state_d = atop_q[axi_pkg::ATOP_R_RESP] ? ATOP_R : SEND_B;
+          load_state = 1'b1;
+        end
+      end
+      // ~> return the old data
+      ATOP_R: begin
+        slave.r_valid = 1'b1;
+        slave.r_data  = atop_obuf_q[int'({ax_req_q.addr[AXI_ADDR_WIDTH-1:LOG_NR_BYTES],
+                                          {{LOG_NR_BYTES} {1'b0}}} - atop_win) +
+                                    cnt_q*NR_BYTES+:NR_BYTES];
+        slave.r_user  = '0;
+        slave.r_id    = ax_req_q.id;
+        slave.r_last  = (cnt_q == atop_r_beats - 1);
+        if (slave.r_ready) begin
+          cnt_d = cnt_q + 1;
+          load_cnt = 1'b1;
+          if (slave.r_last) begin
+            state_d = SEND_B;
+            load_state = 1'b1;
+          end
+        end
+      end
       default: begin
         state_d = IDLE;
         load_state = 1'b1;
@@ -339,4 +516,7 @@ module axi2mem #(
   `FFLARN(ax_req_q, ax_req_d, load_ax_req, '0, clk_i, rst_ni)
   `FFLARN(req_addr_q, req_addr_d, load_req_addr, '0, clk_i, rst_ni)
   `FFLARN(cnt_q, cnt_d, load_cnt, '0, clk_i, rst_ni)
+  `FFLARN(atop_q, atop_d, load_atop, '0, clk_i, rst_ni)
+  `FFLARN(atop_wbuf_q, atop_wbuf_d, load_atop_wbuf, '0, clk_i, rst_ni)
+  `FFLARN(atop_obuf_q, atop_obuf_d, load_atop_obuf, '0, clk_i, rst_ni)
 endmodule
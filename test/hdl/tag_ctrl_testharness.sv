@@ -15,7 +15,13 @@ module tag_ctrl_testharness #(
     parameter int unsigned AXI_DATA_WIDTH = 64'd64,
     parameter int unsigned AXI_ID_WIDTH   = 64'd6,
     parameter int unsigned AXI_USER_WIDTH = 64'd1,
-    parameter int unsigned AXI_STRB_WIDTH = AXI_DATA_WIDTH / 8
+    parameter int unsigned AXI_STRB_WIDTH = AXI_DATA_WIDTH / 8,
+    /// Tag cache replacement policy, encoded as `axi_tagctrl_pkg::repl_policy_e`
+    parameter int unsigned TAG_REPL_POLICY = 0,
+    /// Number of slave ports of the tag controller, in `[1, 2]`, the `cpu1_*` signals drive port 1
+    parameter int unsigned NUM_SLV_PORTS = 1,
+    /// Arbitration weight of slave port 0, all other slave ports have weight 1
+    parameter int unsigned SLV_PORT0_WEIGHT = 1
 ) (
     input  logic                                 clk_i,         /// Clock
     input  logic                                 rst_ni,        /// Asynchronous reset active low
@@ -25,6 +31,7 @@ module tag_ctrl_testharness #(
     input  axi_pkg::size_t                       cpu_aw_size,
     input  axi_pkg::burst_t                      cpu_aw_burst,
     input  logic            [AXI_USER_WIDTH-1:0] cpu_aw_user,
+    input  axi_pkg::atop_t                       cpu_aw_atop,
     input  logic                                 cpu_aw_valid,
     output logic                                 cpu_aw_ready,
 
@@ -56,7 +63,72 @@ module tag_ctrl_testharness #(
     output logic                                cpu_r_last,
     output logic           [AXI_USER_WIDTH-1:0] cpu_r_user,
     output logic                                cpu_r_valid,
-    input  logic                                cpu_r_ready
+    input  logic                                cpu_r_ready,
+
+    /// Slave port 1, unused with a single slave port
+    input  logic            [  AXI_ID_WIDTH-1:0] cpu1_aw_id,
+    input  logic            [AXI_ADDR_WIDTH-1:0] cpu1_aw_addr,
+    input  axi_pkg::len_t                        cpu1_aw_len,
+    input  axi_pkg::size_t                       cpu1_aw_size,
+    input  axi_pkg::burst_t                      cpu1_aw_burst,
+    input  logic            [AXI_USER_WIDTH-1:0] cpu1_aw_user,
+    input  axi_pkg::atop_t                       cpu1_aw_atop,
+    input  logic                                 cpu1_aw_valid,
+    output logic                                 cpu1_aw_ready,
+
+    input  logic [AXI_DATA_WIDTH-1:0] cpu1_w_data,
+    input  logic [AXI_STRB_WIDTH-1:0] cpu1_w_strb,
+    input  logic                      cpu1_w_last,
+    input  logic [AXI_USER_WIDTH-1:0] cpu1_w_user,
+    input  logic                      cpu1_w_valid,
+    output logic                      cpu1_w_ready,
+
+    output logic           [  AXI_ID_WIDTH-1:0] cpu1_b_id,
+    output axi_pkg::resp_t                      cpu1_b_resp,
+    output logic           [AXI_USER_WIDTH-1:0] cpu1_b_user,
+    output logic                                cpu1_b_valid,
+    input  logic                                cpu1_b_ready,
+
+    input  logic            [  AXI_ID_WIDTH-1:0] cpu1_ar_id,
+    input  logic            [AXI_ADDR_WIDTH-1:0] cpu1_ar_addr,
+    input  axi_pkg::len_t                        cpu1_ar_len,
+    input  axi_pkg::size_t                       cpu1_ar_size,
+    input  axi_pkg::burst_t                      cpu1_ar_burst,
+    input  logic            [AXI_USER_WIDTH-1:0] cpu1_ar_user,
+    input  logic                                 cpu1_ar_valid,
+    output logic                                 cpu1_ar_ready,
+
+    output logic           [  AXI_ID_WIDTH-1:0] cpu1_r_id,
+    output logic           [AXI_DATA_WIDTH-1:0] cpu1_r_data,
+    output axi_pkg::resp_t                      cpu1_r_resp,
+    output logic                                cpu1_r_last,
+    output logic           [AXI_USER_WIDTH-1:0] cpu1_r_user,
+    output logic                                cpu1_r_valid,
+    input  logic                                cpu1_r_ready,
+
+    input  logic [31:0] cfg_req_addr,
+    input  logic        cfg_req_write,
+    input  logic [31:0] cfg_req_wdata,
+    input  logic [ 3:0] cfg_req_wstrb,
+    input  logic        cfg_req_valid,
+    output logic [31:0] cfg_rsp_rdata,
+    output logic        cfg_rsp_error,
+    output logic        cfg_rsp_ready,
+
+    /// Memory writes starting at `mem_err_addr` get a SLVERR response while `mem_err_en` is set
+    input  logic                      mem_err_en,
+    input  logic [AXI_ADDR_WIDTH-1:0] mem_err_addr,
+
+    /// Number of memory reads and writes to the tag cache region
+    output logic [63:0] mem_tag_rd_cnt,
+    output logic [63:0] mem_tag_wr_cnt,
+
+    /// Valid and ready of the internal pipeline stages, one bit per stage, see `NumStages`
+    output logic [31:0] stage_valid,
+    output logic [31:0] stage_ready,
+
+    /// Interrupt of the tag controller register file
+    output logic        irq
 );
   /*verilator public_on*/
   localparam int unsigned CapSize = 128;
@@ -72,13 +144,21 @@ module tag_ctrl_testharness #(
   localparam int unsigned SetAssociativity = 32'd8;
   localparam int unsigned NumLines = 32'd128;
   localparam int unsigned NumBlocks = 32'd4;
+  localparam int unsigned TagCtrlRegOffset = axi_tagctrl_pkg::TagCtrlRegOffset;
+  localparam int unsigned ReplPolicy = TAG_REPL_POLICY;
+  localparam int unsigned NumStages = 32'd14;
+  localparam int unsigned TagBufEntries = axi_tagctrl_pkg::TagBufEntries;
+  localparam int unsigned NumSlvPorts = NUM_SLV_PORTS;
   /*verilator public_off*/
+  localparam int unsigned SlvPortWeights[NumSlvPorts] = '{0: SLV_PORT0_WEIGHT, default: 32'd1};
+  /// Extra ID bits of the master port, see (module.axi_tagctrl_top)
+  localparam int unsigned MstIdExtWidth = $clog2(NumSlvPorts + 32'd1);
   /////////////////////////////
   // Axi channel definitions //
   /////////////////////////////
   localparam int unsigned AxiStrbWidth = AxiDataWidth / 32'd8;
   typedef logic [AxiIdWidth-1:0] axi_slv_id_t;
-  typedef logic [AxiIdWidth:0] axi_mst_id_t;
+  typedef logic [AxiIdWidth+MstIdExtWidth-1:0] axi_mst_id_t;
   typedef logic [AxiAddrWidth-1:0] axi_addr_t;
   typedef logic [AxiDataWidth-1:0] axi_data_t;
   typedef logic [AxiStrbWidth-1:0] axi_strb_t;
@@ -112,9 +192,22 @@ module tag_ctrl_testharness #(
   localparam axi_addr_t CachedRegionStart = axi_addr_t'(TagCacheMemBase);
   localparam axi_addr_t CachedRegionLength = axi_addr_t'(2 * TagCacheMemLength);
 
+  // Configuration port
+  conf_req_t     conf_req;
+  conf_rsp_t     conf_rsp;
+
+  assign conf_req.addr  = cfg_req_addr;
+  assign conf_req.write = cfg_req_write;
+  assign conf_req.wdata = cfg_req_wdata;
+  assign conf_req.wstrb = cfg_req_wstrb;
+  assign conf_req.valid = cfg_req_valid;
+  assign cfg_rsp_rdata  = conf_rsp.rdata;
+  assign cfg_rsp_error  = conf_rsp.error;
+  assign cfg_rsp_ready  = conf_rsp.ready;
+
   // AXI channels
-  axi_slv_req_t  axi_cpu_req;
-  axi_slv_resp_t axi_cpu_res;
+  axi_slv_req_t  [NumSlvPorts-1:0] axi_cpu_req;
+  axi_slv_resp_t [NumSlvPorts-1:0] axi_cpu_res;
   axi_mst_req_t  axi_mem_req;
   axi_mst_resp_t axi_mem_res;
 
@@ -128,12 +221,12 @@ module tag_ctrl_testharness #(
   AXI_BUS #(
       .AXI_ADDR_WIDTH(AxiAddrWidth),
       .AXI_DATA_WIDTH(AxiDataWidth),
-      .AXI_ID_WIDTH  (AxiIdWidth + 64'd1),
+      .AXI_ID_WIDTH  (AxiIdWidth + MstIdExtWidth),
       .AXI_USER_WIDTH(AxiUserWidth)
   ) axi_dram ();
 
-  `AXI_ASSIGN_TO_REQ(axi_cpu_req, axi_cpu)
-  `AXI_ASSIGN_FROM_RESP(axi_cpu, axi_cpu_res)
+  `AXI_ASSIGN_TO_REQ(axi_cpu_req[0], axi_cpu)
+  `AXI_ASSIGN_FROM_RESP(axi_cpu, axi_cpu_res[0])
 
   assign axi_cpu.aw_id = cpu_aw_id;
   assign axi_cpu.aw_addr = cpu_aw_addr;
@@ -141,6 +234,7 @@ module tag_ctrl_testharness #(
   assign axi_cpu.aw_size = cpu_aw_size;
   assign axi_cpu.aw_burst = cpu_aw_burst;
   assign axi_cpu.aw_user = cpu_aw_user;
+  assign axi_cpu.aw_atop = cpu_aw_atop;
   assign axi_cpu.aw_valid = cpu_aw_valid;
 
   assign cpu_aw_ready = axi_cpu.aw_ready;
@@ -184,6 +278,87 @@ module tag_ctrl_testharness #(
 
   assign axi_cpu.r_ready = cpu_r_ready;
 
+  if (NumSlvPorts > 32'd1) begin : gen_cpu1
+    AXI_BUS #(
+        .AXI_ADDR_WIDTH(AxiAddrWidth),
+        .AXI_DATA_WIDTH(AxiDataWidth),
+        .AXI_ID_WIDTH  (AxiIdWidth),
+        .AXI_USER_WIDTH(AxiUserWidth)
+    ) axi_cpu1 ();
+
+    `AXI_ASSIGN_TO_REQ(axi_cpu_req[1], axi_cpu1)
+    `AXI_ASSIGN_FROM_RESP(axi_cpu1, axi_cpu_res[1])
+
+    assign axi_cpu1.aw_id = cpu1_aw_id;
+    assign axi_cpu1.aw_addr = cpu1_aw_addr;
+    assign axi_cpu1.aw_len = cpu1_aw_len;
+    assign axi_cpu1.aw_size = cpu1_aw_size;
+    assign axi_cpu1.aw_burst = cpu1_aw_burst;
+    assign axi_cpu1.aw_lock = '0;
+    assign axi_cpu1.aw_cache = '0;
+    assign axi_cpu1.aw_prot = '0;
+    assign axi_cpu1.aw_qos = '0;
+    assign axi_cpu1.aw_region = '0;
+    assign axi_cpu1.aw_atop = cpu1_aw_atop;
+    assign axi_cpu1.aw_user = cpu1_aw_user;
+    assign axi_cpu1.aw_valid = cpu1_aw_valid;
+
+    assign cpu1_aw_ready = axi_cpu1.aw_ready;
+
+    assign axi_cpu1.w_data = cpu1_w_data;
+    assign axi_cpu1.w_strb = cpu1_w_strb;
+    assign axi_cpu1.w_last = cpu1_w_last;
+    assign axi_cpu1.w_user = cpu1_w_user;
+    assign axi_cpu1.w_valid = cpu1_w_valid;
+
+    assign cpu1_w_ready = axi_cpu1.w_ready;
+
+    assign cpu1_b_id = axi_cpu1.b_id;
+    assign cpu1_b_resp = axi_cpu1.b_resp;
+    assign cpu1_b_user = axi_cpu1.b_user;
+    assign cpu1_b_valid = axi_cpu1.b_valid;
+
+    assign axi_cpu1.b_ready = cpu1_b_ready;
+
+    assign axi_cpu1.ar_id = cpu1_ar_id;
+    assign axi_cpu1.ar_addr = cpu1_ar_addr;
+    assign axi_cpu1.ar_len = cpu1_ar_len;
+    assign axi_cpu1.ar_size = cpu1_ar_size;
+    assign axi_cpu1.ar_burst = cpu1_ar_burst;
+    assign axi_cpu1.ar_lock = '0;
+    assign axi_cpu1.ar_cache = '0;
+    assign axi_cpu1.ar_prot = '0;
+    assign axi_cpu1.ar_qos = '0;
+    assign axi_cpu1.ar_region = '0;
+    assign axi_cpu1.ar_user = cpu1_ar_user;
+    assign axi_cpu1.ar_valid = cpu1_ar_valid;
+
+    assign cpu1_ar_ready = axi_cpu1.ar_ready;
+
+    assign cpu1_r_id = axi_cpu1.r_id;
+    assign cpu1_r_data = axi_cpu1.r_data;
+    assign cpu1_r_resp = axi_cpu1.r_resp;
+    assign cpu1_r_last = axi_cpu1.r_last;
+    assign cpu1_r_user = axi_cpu1.r_user;
+    assign cpu1_r_valid = axi_cpu1.r_valid;
+
+    assign axi_cpu1.r_ready = cpu1_r_ready;
+  end else begin : gen_no_cpu1
+    assign cpu1_aw_ready = 1'b0;
+    assign cpu1_w_ready  = 1'b0;
+    assign cpu1_b_id     = '0;
+    assign cpu1_b_resp   = '0;
+    assign cpu1_b_user   = '0;
+    assign cpu1_b_valid  = 1'b0;
+    assign cpu1_ar_ready = 1'b0;
+    assign cpu1_r_id     = '0;
+    assign cpu1_r_data   = '0;
+    assign cpu1_r_resp   = '0;
+    assign cpu1_r_last   = 1'b0;
+    assign cpu1_r_user   = '0;
+    assign cpu1_r_valid  = 1'b0;
+  end
+
   `AXI_ASSIGN_FROM_REQ(axi_dram, axi_mem_req)
   `AXI_ASSIGN_TO_RESP(axi_mem_res, axi_dram)
 
@@ -207,6 +382,9 @@ module tag_ctrl_testharness #(
       .SetAssociativity(SetAssociativity),
       .NumLines        (NumLines),
       .NumBlocks       (NumBlocks),
+      .ReplPolicy      (axi_tagctrl_pkg::repl_policy_e'(ReplPolicy)),
+      .NumSlvPorts     (NumSlvPorts),
+      .SlvPortWeights  (SlvPortWeights),
       .AxiIdWidth      (AxiIdWidth),
       .AxiAddrWidth    (AxiAddrWidth),
       .AxiDataWidth    (AxiDataWidth),
@@ -227,12 +405,75 @@ module tag_ctrl_testharness #(
       .slv_resp_o         (axi_cpu_res),
       .mst_req_o          (axi_mem_req),
       .mst_resp_i         (axi_mem_res),
-      .conf_req_i         (  /* not used */),
-      .conf_resp_o        (  /* not used */),
+      .conf_req_i         (conf_req),
+      .conf_resp_o        (conf_rsp),
       .cached_start_addr_i(CachedRegionStart),
-      .cached_end_addr_i  (CachedRegionLength)
+      .cached_end_addr_i  (CachedRegionLength),
+      .irq_o              (irq)
   );
 
+  // Tag traffic towards the memory, the tag cache refills and write backs
+  always_ff @(posedge clk_i or negedge rst_ni) begin : proc_mem_tag_cnt
+    if (!rst_ni) begin
+      mem_tag_rd_cnt <= '0;
+      mem_tag_wr_cnt <= '0;
+    end else begin
+      if (axi_mem_req.ar_valid && axi_mem_res.ar_ready &&
+          (axi_mem_req.ar.addr >= axi_addr_t'(TagCacheMemBase))) begin
+        mem_tag_rd_cnt <= mem_tag_rd_cnt + 64'd1;
+      end
+      if (axi_mem_req.aw_valid && axi_mem_res.aw_ready &&
+          (axi_mem_req.aw.addr >= axi_addr_t'(TagCacheMemBase))) begin
+        mem_tag_wr_cnt <= mem_tag_wr_cnt + 64'd1;
+      end
+    end
+  end
+
+  // Handshakes of the internal pipeline stages for the stall attribution of the testbench. The
+  // order has to match `stage_names` in `tag_ctrl_tb.cpp`.
+  always_comb begin : proc_stages
+    stage_valid = '0;
+    stage_ready = '0;
+    // descriptor FIFOs after the AR and AW units of slave port 0
+    stage_valid[0]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_ar_valid[0];
+    stage_ready[0]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_ar_ready[0];
+    stage_valid[1]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_aw_valid[0];
+    stage_ready[1]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_aw_ready[0];
+    // tag cache descriptor arbiter and spill register
+    stage_valid[2]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.rw_desc_valid;
+    stage_ready[2]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.rw_desc_ready;
+    stage_valid[3]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.spill_valid;
+    stage_ready[3]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.spill_ready;
+    // hit and miss path of the hit miss unit
+    stage_valid[4]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.hit_valid;
+    stage_ready[4]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.hit_ready;
+    stage_valid[5]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.miss_valid;
+    stage_ready[5]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.miss_ready;
+    // evict -> refill -> merge -> read / write units
+    stage_valid[6]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.evict_desc_valid;
+    stage_ready[6]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.evict_desc_ready;
+    stage_valid[7]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.refill_desc_valid;
+    stage_ready[7]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.refill_desc_ready;
+    stage_valid[8]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.read_desc_valid;
+    stage_ready[8]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.read_desc_ready;
+    stage_valid[9]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.write_desc_valid;
+    stage_ready[9]  = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.write_desc_ready;
+    // data ways, any unit accessing them
+    stage_valid[10] = |i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.to_way_valid;
+    stage_ready[10] = |(i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.to_way_ready &
+                        (i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.to_way_valid |
+                         {4{!stage_valid[10]}}));
+    // tag words of the W unit towards the tag cache, stalls fill `tag_fifo_full`
+    stage_valid[11] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagc_w_oup_valid;
+    stage_ready[11] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagc_w_oup_ready;
+    // tag words from the tag cache towards the R unit
+    stage_valid[12] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagc_r_inp_valid;
+    stage_ready[12] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagc_r_inp_ready;
+    // R beats from memory, stalls are `mem_fifo_full` of the R unit of slave port 0
+    stage_valid[13] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_resp[0].r_valid;
+    stage_ready[13] = i_axi_tagctrl_reg_wrap_raw.i_axi_tagctrl_top_raw.tagctrl_req[0].r_ready;
+  end
+
   /*   AXI_BUS #(
       .AXI_ADDR_WIDTH(AxiAddrWidth),
       .AXI_DATA_WIDTH(AxiDataWidth),
@@ -258,7 +499,7 @@ module tag_ctrl_testharness #(
   ); */
 
   axi2mem #(
-      .AXI_ID_WIDTH  (AxiIdWidth + 1),
+      .AXI_ID_WIDTH  (AxiIdWidth + MstIdExtWidth),
       .AXI_ADDR_WIDTH(AxiAddrWidth),
       .AXI_DATA_WIDTH(AxiDataWidth),
       .AXI_USER_WIDTH(AxiUserWidth)
@@ -273,7 +514,9 @@ module tag_ctrl_testharness #(
       .user_o(dram_wuser),
       .data_o(dram_wdata),
       .user_i(dram_ruser),
-      .data_i(dram_rdata)
+      .data_i(dram_rdata),
+      .err_en_i  (mem_err_en),
+      .err_addr_i(mem_err_addr)
   );
 
   sram #(
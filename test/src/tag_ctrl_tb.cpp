@@ -34,6 +34,11 @@
 #include <gtest/gtest.h>
 #include <cmath>
 #include <deque>
+#include <map>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
 #include <axi_types.h>
 
 #define MAX_NUM_REPS 500
@@ -41,16 +46,32 @@
 static vluint64_t main_time = 0;
 static std::string dumpfolder = "/test/logs/";
 static std::string dumpfile = "dump.vcd";
+// Seed of all random stimuli, set with -s, a run is reproduced by passing the printed seed
+static uint64_t seed = 0;
+
+// Internal pipeline stages of the tag controller, in the order of `stage_valid` / `stage_ready`
+// of the testharness
+static const char *stage_names[] = {
+    "ar_desc_fifo", "aw_desc_fifo", "rw_arb_tree", "rw_spill", "hit", "miss_evict",
+    "refill", "merge", "read_unit", "write_unit", "data_ways", "w_tag_fifo", "r_tag_words",
+    "r_mem_fifo"};
 
 class CTagctrl_tb : public ::testing::Test
 {
 protected:
   Vtag_ctrl_testharness *top;
   VerilatedVcdC *tfp;
+  // Cycles per stage with a handshake, with valid but no ready and with ready but no valid
+  std::vector<uint64_t> stage_active, stage_stalled, stage_starved;
+  uint64_t stage_cycles;
 
   void SetUp()
   {
     main_time = 0;
+    stage_active.assign(Vtag_ctrl_testharness_tag_ctrl_testharness::NumStages, 0);
+    stage_stalled.assign(Vtag_ctrl_testharness_tag_ctrl_testharness::NumStages, 0);
+    stage_starved.assign(Vtag_ctrl_testharness_tag_ctrl_testharness::NumStages, 0);
+    stage_cycles = 0;
     top = new (Vtag_ctrl_testharness);
 #if VM_TRACE
     // Enable Trace
@@ -66,6 +87,7 @@ protected:
 
   void TearDown()
   {
+    stall_report();
     delete top;
 #if VM_TRACE
     tfp->close();
@@ -108,6 +130,7 @@ public:
 #if VM_TRACE
       tfp->dump(static_cast<vluint64_t>(main_time * 2));
 #endif
+      sample_stages();
       top->clk_i = 1;
       top->eval();
 #if VM_TRACE
@@ -116,6 +139,40 @@ public:
       main_time++;
     }
   }
+
+  // Attribute the cycle to the pipeline stages, the handshakes are stable before the rising edge
+  void sample_stages()
+  {
+    stage_cycles++;
+    for (size_t s = 0; s < stage_active.size(); s++)
+    {
+      bool valid = (top->stage_valid >> s) & 1;
+      bool ready = (top->stage_ready >> s) & 1;
+      if (valid && ready)
+        stage_active[s]++;
+      else if (valid)
+        stage_stalled[s]++;
+      else if (ready)
+        stage_starved[s]++;
+    }
+  }
+
+  // Per stage breakdown of the cycles of the test, the stage with the most stalled cycles is
+  // the one holding back its predecessors
+  void stall_report()
+  {
+    std::cout << "Stall attribution over " << stage_cycles << " cycles" << std::endl;
+    std::cout << std::left << std::setw(14) << "stage" << std::right << std::setw(12) << "active"
+              << std::setw(12) << "stalled" << std::setw(12) << "starved" << std::endl;
+    for (size_t s = 0; s < stage_active.size(); s++)
+    {
+      std::cout << std::left << std::setw(14) << stage_names[s] << std::right << std::fixed
+                << std::setprecision(2);
+      for (uint64_t cnt : {stage_active[s], stage_stalled[s], stage_starved[s]})
+        std::cout << std::setw(11) << (stage_cycles ? 100.0 * cnt / stage_cycles : 0.0) << "%";
+      std::cout << std::endl;
+    }
+  }
 };
 
 class CTagCtrlDriver_tb
@@ -129,12 +186,13 @@ public:
   {
     this->dut = dut;
     this->tb = tb;
-    srand(time(0));
+    srand((unsigned int)seed);
   }
 
   void reset_slave()
   {
     dut->cpu_aw_addr = 0;
+    dut->cpu_aw_atop = 0;
     dut->cpu_aw_valid = 0;
     dut->cpu_w_valid = 0;
     dut->cpu_w_data = 0;
@@ -144,6 +202,167 @@ public:
     dut->cpu_ar_valid = 0;
     dut->cpu_ar_addr = 0;
     dut->cpu_r_ready = 0;
+    dut->cfg_req_valid = 0;
+  }
+
+  void cfg_write(uint32_t addr, uint32_t data)
+  {
+    dut->cfg_req_addr = addr;
+    dut->cfg_req_write = 1;
+    dut->cfg_req_wdata = data;
+    dut->cfg_req_wstrb = 0xf;
+    dut->cfg_req_valid = 1;
+    tb->tick(1);
+    while (dut->cfg_rsp_ready != 1)
+      tb->tick(1);
+    dut->cfg_req_valid = 0;
+    dut->cfg_req_write = 0;
+  }
+
+  uint32_t cfg_read(uint32_t addr)
+  {
+    dut->cfg_req_addr = addr;
+    dut->cfg_req_write = 0;
+    dut->cfg_req_valid = 1;
+    dut->eval();
+    while (dut->cfg_rsp_ready != 1)
+      tb->tick(1);
+    uint32_t rdata = dut->cfg_rsp_rdata;
+    tb->tick(1);
+    dut->cfg_req_valid = 0;
+    return rdata;
+  }
+
+  // Map an address region of the tag controller register file, see `axi_tagctrl_regs`
+  void cfg_addr_region(unsigned int idx, uint64_t start_addr, uint64_t end_addr, bool untagged)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + idx * 0x20;
+    cfg_write(base + 0x00, (uint32_t)start_addr);
+    cfg_write(base + 0x04, (uint32_t)(start_addr >> 32));
+    cfg_write(base + 0x08, (uint32_t)end_addr);
+    cfg_write(base + 0x0C, (uint32_t)(end_addr >> 32));
+    cfg_write(base + 0x10, untagged ? 0x3 : 0x1);
+  }
+
+  // Configure a tag cache way partition, see `axi_tagctrl_regs`
+  void cfg_partition(unsigned int idx, uint32_t id_first, uint32_t id_last, uint64_t way_mask)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x100 + idx * 0x20;
+    cfg_write(base + 0x00, id_first);
+    cfg_write(base + 0x04, id_last);
+    cfg_write(base + 0x08, 0);
+    cfg_write(base + 0x0C, 0);
+    cfg_write(base + 0x10, (uint32_t)way_mask);
+    cfg_write(base + 0x14, (uint32_t)(way_mask >> 32));
+    cfg_write(base + 0x18, 0x1);
+  }
+
+  // Read the hit and miss counters of a tag cache way partition
+  uint64_t cfg_partition_hits(unsigned int idx)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x200 + idx * 0x10;
+    return ((uint64_t)cfg_read(base + 0x04) << 32) | cfg_read(base + 0x00);
+  }
+
+  uint64_t cfg_partition_misses(unsigned int idx)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x200 + idx * 0x10;
+    return ((uint64_t)cfg_read(base + 0x0C) << 32) | cfg_read(base + 0x08);
+  }
+
+  // Start a background flush of the tag cache, see `axi_tagctrl_regs`
+  void cfg_flush(bool range, uint64_t start_addr, uint64_t end_addr)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x300;
+    cfg_write(base + 0x08, (uint32_t)start_addr);
+    cfg_write(base + 0x0C, (uint32_t)(start_addr >> 32));
+    cfg_write(base + 0x10, (uint32_t)end_addr);
+    cfg_write(base + 0x14, (uint32_t)(end_addr >> 32));
+    cfg_write(base + 0x00, range ? 0x3 : 0x1);
+  }
+
+  bool cfg_flush_busy()
+  {
+    return cfg_read(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x304) & 0x1;
+  }
+
+  // Read and clear the number of tag lines written back by background flushes
+  uint32_t cfg_flush_lines()
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x300;
+    uint32_t lines = cfg_read(base + 0x18);
+    cfg_write(base + 0x18, 0);
+    return lines;
+  }
+
+  // Enable posted writes and their error interrupt, see `axi_tagctrl_regs`
+  void cfg_posted(bool en, bool irq_en)
+  {
+    uint32_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x400;
+    cfg_write(base + 0x00, (irq_en ? 0x2 : 0x0) | (en ? 0x1 : 0x0));
+  }
+
+  // Error pending bit and response of the first failed posted write
+  uint32_t cfg_posted_status()
+  {
+    return cfg_read(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x404);
+  }
+
+  // Single beat read of a 64-bit word
+  axi_r_beat_t read_word(uint64_t addr)
+  {
+    axi_ax_beat_t ar_beat = {0};
+    ar_beat.ax_addr = addr;
+    ar_beat.ax_size = 3;
+    ar_beat.ax_burst = BURST_INCR;
+    send_ar(ar_beat);
+    axi_r_beat_t r_beat = recv_r();
+    dut->cpu_r_ready = 0;
+    return r_beat;
+  }
+
+  // Single beat write of a 64-bit word
+  axi_b_beat_t write_word(uint64_t addr, uint64_t data, unsigned int user)
+  {
+    axi_ax_beat_t aw_beat = {0};
+    aw_beat.ax_addr = addr;
+    aw_beat.ax_size = 3;
+    aw_beat.ax_burst = BURST_INCR;
+    send_aw(aw_beat);
+    axi_w_beat_t w_beat = {0};
+    w_beat.w_data = data;
+    w_beat.w_strb = 0xff;
+    w_beat.w_user = user;
+    w_beat.w_last = 1;
+    send_w(w_beat);
+    return recv_b();
+  }
+
+  // Atomic transaction with 64-bit W beats, `atop` is encoded as `axi_pkg::atop_t`. The R beats
+  // of atomics with an R response are returned in `r_beats`, they arrive before the B response.
+  axi_b_beat_t atomic(uint64_t addr, uint8_t atop, axi_burst_t burst,
+                      const std::vector<axi_w_beat_t> &w_beats, std::vector<axi_r_beat_t> &r_beats)
+  {
+    axi_ax_beat_t aw_beat = {0};
+    aw_beat.ax_addr = addr;
+    aw_beat.ax_len = w_beats.size() - 1;
+    aw_beat.ax_size = 3;
+    aw_beat.ax_burst = burst;
+    dut->cpu_aw_atop = atop;
+    send_aw(aw_beat);
+    dut->cpu_aw_atop = 0;
+    for (auto w_beat : w_beats)
+      send_w(w_beat);
+    r_beats.clear();
+    // ATOP_R_RESP
+    if (atop & 0x20)
+    {
+      do
+        r_beats.push_back(recv_r());
+      while (!r_beats.back().r_last);
+      dut->cpu_r_ready = 0;
+    }
+    return recv_b();
   }
 
   void send_aw(axi_ax_beat_t aw_beat)
@@ -290,6 +509,293 @@ public:
   }
 };
 
+// Signal `sig` of the slave port `port` of the testharness, port 1 is driven by the `cpu1_*` signals
+#define CPU_PORT(port, sig) (*((port) ? &dut->cpu1_##sig : &dut->cpu_##sig))
+
+// Cycle driven agent of one slave port with a single burst in flight. Agents of different ports
+// stepped in the same cycle interleave their traffic.
+class CPortAgent_tb
+{
+private:
+  Vtag_ctrl_testharness *dut;
+  unsigned int port;
+  enum
+  {
+    AGENT_IDLE,
+    AGENT_AX,
+    AGENT_W,
+    AGENT_RESP
+  } state;
+  size_t beat;
+  bool b_done, r_done;
+
+  axi_r_beat_t sample_r()
+  {
+    return {(unsigned int)CPU_PORT(port, r_id), CPU_PORT(port, r_data),
+            (axi_resp_t)CPU_PORT(port, r_resp), (unsigned int)CPU_PORT(port, r_last),
+            (unsigned int)CPU_PORT(port, r_user), 1};
+  }
+
+public:
+  axi_ax_beat_t ax_beat;
+  uint8_t atop;  // `axi_pkg::atop_t` of a write burst
+  bool write;
+  std::vector<axi_w_beat_t> w_beats;
+  std::vector<axi_r_beat_t> r_beats;
+  axi_b_beat_t b_beat;
+
+  CPortAgent_tb(Vtag_ctrl_testharness *dut, unsigned int port)
+  {
+    this->dut = dut;
+    this->port = port;
+    this->state = AGENT_IDLE;
+  }
+
+  bool idle() const { return state == AGENT_IDLE; }
+
+  // Start a write burst with the W beats `w_beats`, or a read burst if `w_beats` is empty. The R
+  // beats of an atomic write burst are collected in `r_beats`.
+  void start(axi_ax_beat_t ax_beat, const std::vector<axi_w_beat_t> &w_beats, uint8_t atop = 0)
+  {
+    this->ax_beat = ax_beat;
+    this->atop = atop;
+    this->write = !w_beats.empty();
+    this->w_beats = w_beats;
+    r_beats.clear();
+    beat = 0;
+    b_done = false;
+    // ATOP_R_RESP
+    r_done = !(atop & 0x20);
+    state = AGENT_AX;
+  }
+
+  // Drive the port for the next clock edge, the caller ticks once after stepping all agents.
+  // Returns true if the burst got its last response in this cycle.
+  bool step()
+  {
+    CPU_PORT(port, aw_valid) = 0;
+    CPU_PORT(port, aw_atop) = 0;
+    CPU_PORT(port, w_valid) = 0;
+    CPU_PORT(port, b_ready) = 0;
+    CPU_PORT(port, ar_valid) = 0;
+    CPU_PORT(port, r_ready) = 0;
+    switch (state)
+    {
+    case AGENT_AX:
+      if (write)
+      {
+        CPU_PORT(port, aw_id) = ax_beat.ax_id;
+        CPU_PORT(port, aw_addr) = ax_beat.ax_addr;
+        CPU_PORT(port, aw_len) = ax_beat.ax_len;
+        CPU_PORT(port, aw_size) = ax_beat.ax_size;
+        CPU_PORT(port, aw_burst) = ax_beat.ax_burst;
+        CPU_PORT(port, aw_user) = ax_beat.ax_user;
+        CPU_PORT(port, aw_atop) = atop;
+        CPU_PORT(port, aw_valid) = 1;
+        if (CPU_PORT(port, aw_ready))
+          state = AGENT_W;
+      }
+      else
+      {
+        CPU_PORT(port, ar_id) = ax_beat.ax_id;
+        CPU_PORT(port, ar_addr) = ax_beat.ax_addr;
+        CPU_PORT(port, ar_len) = ax_beat.ax_len;
+        CPU_PORT(port, ar_size) = ax_beat.ax_size;
+        CPU_PORT(port, ar_burst) = ax_beat.ax_burst;
+        CPU_PORT(port, ar_user) = ax_beat.ax_user;
+        CPU_PORT(port, ar_valid) = 1;
+        if (CPU_PORT(port, ar_ready))
+          state = AGENT_RESP;
+      }
+      return false;
+    case AGENT_W:
+      CPU_PORT(port, w_data) = w_beats[beat].w_data;
+      CPU_PORT(port, w_strb) = w_beats[beat].w_strb;
+      CPU_PORT(port, w_last) = w_beats[beat].w_last;
+      CPU_PORT(port, w_user) = w_beats[beat].w_user;
+      CPU_PORT(port, w_valid) = 1;
+      if (CPU_PORT(port, w_ready) && (++beat == w_beats.size()))
+        state = AGENT_RESP;
+      return false;
+    case AGENT_RESP:
+      if (write)
+      {
+        // an atomic gets its R beats besides the B response
+        CPU_PORT(port, b_ready) = !b_done;
+        CPU_PORT(port, r_ready) = !r_done;
+        if (!r_done && CPU_PORT(port, r_valid))
+        {
+          r_beats.push_back(sample_r());
+          r_done = r_beats.back().r_last;
+        }
+        if (!b_done && CPU_PORT(port, b_valid))
+        {
+          b_beat.b_id = CPU_PORT(port, b_id);
+          b_beat.b_resp = (axi_resp_t)CPU_PORT(port, b_resp);
+          b_beat.b_user = CPU_PORT(port, b_user);
+          b_beat.b_valid = 1;
+          b_done = true;
+        }
+        if (!b_done || !r_done)
+          return false;
+        state = AGENT_IDLE;
+        return true;
+      }
+      CPU_PORT(port, r_ready) = 1;
+      if (!CPU_PORT(port, r_valid))
+        return false;
+      r_beats.push_back(sample_r());
+      if (!r_beats.back().r_last)
+        return false;
+      state = AGENT_IDLE;
+      return true;
+    default:
+      return false;
+    }
+  }
+};
+
+// Access pattern of a workload profile
+enum workload_pattern_t
+{
+  PATTERN_STREAM,        // sequential bursts over the footprint
+  PATTERN_STRIDED,       // bursts at a fixed stride
+  PATTERN_HOT_SET,       // most accesses go to a small hot set of pages
+  PATTERN_ZIPF,          // page popularity follows a Zipf distribution
+  PATTERN_POINTER_CHASE  // single capability accesses along a random permutation
+};
+
+typedef struct workload_profile
+{
+  std::string name;
+  workload_pattern_t pattern;
+  unsigned int num_ids;      // number of AXI IDs used
+  uint8_t min_len;           // burst length range, AXI len
+  uint8_t max_len;
+  double tag_density;        // probability of a written capability to be tagged
+  double write_ratio;        // probability of an access to be a write
+  uint32_t footprint_pages;  // 4KiB pages touched by the workload
+  uint32_t stride;           // stride in bytes, PATTERN_STRIDED
+  uint32_t hot_pages;        // size of the hot set, PATTERN_HOT_SET
+  double hot_ratio;          // probability of an access to the hot set
+  double zipf_alpha;         // skew, PATTERN_ZIPF
+} workload_profile_t;
+
+// Named workload profiles of CWorkloadGen_tb
+static const std::vector<workload_profile_t> workload_profiles = {
+    {"stream", PATTERN_STREAM, 1, 15, 63, 0.25, 0.5, 64, 0, 0, 0.0, 0.0},
+    {"strided", PATTERN_STRIDED, 4, 0, 7, 0.5, 0.3, 256, 4096 + 256, 0, 0.0, 0.0},
+    {"hot_set", PATTERN_HOT_SET, 8, 0, 15, 0.5, 0.3, 2048, 0, 16, 0.9, 0.0},
+    {"zipf", PATTERN_ZIPF, 16, 0, 7, 0.5, 0.2, 4096, 0, 0, 0.0, 1.1},
+    {"pointer_chase", PATTERN_POINTER_CHASE, 2, 1, 1, 0.95, 0.1, 512, 0, 0, 0.0, 0.0},
+    {"write_heavy", PATTERN_HOT_SET, 4, 0, 31, 0.1, 0.9, 512, 0, 64, 0.7, 0.0},
+};
+
+// Seeded stimulus generator for a workload profile. The same seed and profile always produce
+// the same sequence of bursts.
+class CWorkloadGen_tb
+{
+private:
+  workload_profile_t profile;
+  std::mt19937_64 rng;
+  uint64_t next_addr;
+  std::vector<double> zipf_cdf;
+  std::vector<uint64_t> chase;
+  size_t chase_pos;
+
+  uint64_t page_addr(uint64_t page)
+  {
+    return Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase + page * 4096;
+  }
+
+  double uniform()
+  {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+  }
+
+public:
+  CWorkloadGen_tb(const workload_profile_t &profile, uint64_t seed) : profile(profile), rng(seed)
+  {
+    next_addr = page_addr(0);
+    chase_pos = 0;
+    if (profile.pattern == PATTERN_ZIPF)
+    {
+      double sum = 0;
+      for (uint32_t p = 0; p < profile.footprint_pages; p++)
+      {
+        sum += 1.0 / std::pow(p + 1, profile.zipf_alpha);
+        zipf_cdf.push_back(sum);
+      }
+      for (double &c : zipf_cdf)
+        c /= sum;
+    }
+    if (profile.pattern == PATTERN_POINTER_CHASE)
+    {
+      // one pointer per 64B, visited along a random cycle
+      for (uint64_t i = 0; i < profile.footprint_pages * 4096 / 64; i++)
+        chase.push_back(page_addr(0) + i * 64);
+      std::shuffle(chase.begin(), chase.end(), rng);
+    }
+  }
+
+  const workload_profile_t &get_profile() { return profile; }
+
+  bool next_is_write() { return uniform() < profile.write_ratio; }
+
+  // Next burst of the profile, INCR bursts of 64-bit beats which stay inside of their 4KiB page
+  axi_ax_beat_t next_ax_beat()
+  {
+    axi_ax_beat_t ax_beat = {0};
+    uint64_t page;
+    ax_beat.ax_id = rng() % profile.num_ids;
+    ax_beat.ax_len = profile.min_len + rng() % (profile.max_len - profile.min_len + 1);
+    ax_beat.ax_size = 3;
+    ax_beat.ax_burst = BURST_INCR;
+    switch (profile.pattern)
+    {
+    case PATTERN_STREAM:
+    case PATTERN_STRIDED:
+      ax_beat.ax_addr = next_addr;
+      next_addr += (profile.pattern == PATTERN_STREAM) ? (ax_beat.ax_len + 1) * 8 : profile.stride;
+      if (next_addr >= page_addr(profile.footprint_pages))
+        next_addr = page_addr(0) + (next_addr - page_addr(profile.footprint_pages)) % 4096;
+      break;
+    case PATTERN_HOT_SET:
+      page = (uniform() < profile.hot_ratio) ? rng() % profile.hot_pages
+                                             : rng() % profile.footprint_pages;
+      ax_beat.ax_addr = page_addr(page) + (rng() % 256) * 16;
+      break;
+    case PATTERN_ZIPF:
+      page = std::lower_bound(zipf_cdf.begin(), zipf_cdf.end(), uniform()) - zipf_cdf.begin();
+      ax_beat.ax_addr = page_addr(std::min<uint64_t>(page, profile.footprint_pages - 1)) +
+                        (rng() % 256) * 16;
+      break;
+    case PATTERN_POINTER_CHASE:
+      ax_beat.ax_addr = chase[chase_pos];
+      chase_pos = (chase_pos + 1) % chase.size();
+      break;
+    }
+    // bursts must not cross a 4KiB boundary
+    uint64_t page_left = (4096 - (ax_beat.ax_addr & 4095)) / 8;
+    if (ax_beat.ax_len >= page_left)
+      ax_beat.ax_len = page_left - 1;
+    return ax_beat;
+  }
+
+  // Write beat of a capability, both halves of a capability carry the same tag bit
+  axi_w_beat_t next_w_beat(uint64_t addr, bool last, std::map<uint64_t, unsigned int> &cap_tags)
+  {
+    axi_w_beat_t w_beat = {0};
+    w_beat.w_data = rng();
+    w_beat.w_strb = 0xff;
+    w_beat.w_last = last;
+    if (((addr & 15) == 0) || !cap_tags.count(addr >> 4))
+      cap_tags[addr >> 4] = (uniform() < profile.tag_density) ? 1 : 0;
+    w_beat.w_user = cap_tags[addr >> 4];
+    return w_beat;
+  }
+};
+
 static void usage(const char *program_name)
 {
   fputs("\
@@ -298,6 +804,7 @@ static void usage(const char *program_name)
         stdout);
   fputs("\
   -v,                      Write vcd trace to FILE\n\
+  -s SEED                  Seed of the random stimuli, printed at the start of a run\n\
   ",
         stdout);
 }
@@ -372,34 +879,1541 @@ TEST_F(CTagctrl_tb, Rand_AXI_RW_OP)
   delete driver;
 }
 
-int main(int argc, char **argv)
+// Maximum length bursts starting anywhere in a page span up to three tag words. Their tag words
+// stream from the tag cache, each burst needs one tag cache lookup per tag cache line it touches.
+TEST_F(CTagctrl_tb, Rand_AXI_Long_Burst_RW_OP)
 {
-  std::clock_t c_start = std::clock();
-  auto t_start = std::chrono::high_resolution_clock::now();
-  int option_index = 0;
-  char *filename = nullptr;
-#if VM_TRACE
-  while ((option_index = getopt(argc, argv, "hv:")) != -1)
-#else
-  while ((option_index = getopt(argc, argv, "h")) != -1)
-#endif
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t tag_line_cover = Vtag_ctrl_testharness_tag_ctrl_testharness::NumBlocks * 64 *
+                                  (Vtag_ctrl_testharness_tag_ctrl_testharness::CapSize / 8);
+  axi_ax_beat_t aw_beat;
+  axi_ax_beat_t ar_beat;
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  axi_b_beat_t b_beat;
+  std::deque<axi_w_beat_t> axi_w_beat_q;
+  uint64_t lookups = 0;
+  tick(2500);
+  driver->reset_slave();
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
   {
-    switch (option_index)
+    aw_beat = driver->rand_ax_beat();
+    aw_beat.ax_len = 255;
+    // capability aligned start, the burst stays inside of its 4KiB page
+    aw_beat.ax_addr += (rand() % ((page - (aw_beat.ax_len + 1) * 8) / 16 + 1)) * 16;
+    ar_beat = aw_beat;
+    driver->reset_slave();
+    driver->send_aw(aw_beat);
+    for (uint64_t i = 0; i <= aw_beat.ax_len; i++)
     {
-    // Process long and short EMULATOR options
-    case 'h':
-      usage(argv[0]);
-      return 1;
-#if VM_TRACE
-    case 'v':
+      w_beat = driver->rand_w_beat((i == aw_beat.ax_len) ? 1 : 0);
+      // both halves of a capability carry the same tag bit
+      if (i % 2)
+        w_beat.w_user = axi_w_beat_q.back().w_user;
+      driver->send_w(w_beat);
+      axi_w_beat_q.push_back(w_beat);
+    }
+    b_beat = driver->recv_b();
+    ASSERT_EQ(b_beat.b_id, aw_beat.ax_id);
+    ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+    driver->send_ar(ar_beat);
+    for (uint64_t i = 0; i <= ar_beat.ax_len; i++)
     {
-      dumpfolder = optarg;
-      std::cout << "VCD dump folder path: " << dumpfolder << std::endl;
-      break;
+      r_beat = driver->recv_r();
+      w_beat = axi_w_beat_q.front();
+      axi_w_beat_q.pop_front();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, (i == ar_beat.ax_len) ? 1 : 0);
+      ASSERT_EQ(r_beat.r_user, w_beat.w_user);
     }
-#endif
+    uint64_t last_addr = aw_beat.ax_addr + aw_beat.ax_len * 8;
+    lookups += 2 * (last_addr / tag_line_cover - aw_beat.ax_addr / tag_line_cover + 1);
+  }
+  ASSERT_EQ(driver->cfg_partition_hits(0) + driver->cfg_partition_misses(0), lookups);
+  delete driver;
+}
+
+TEST_F(CTagctrl_tb, Rand_AXI_WRAP_RW_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  axi_ax_beat_t aw_beat;
+  axi_ax_beat_t ar_beat;
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  axi_b_beat_t b_beat;
+  std::deque<axi_w_beat_t> axi_w_beat_q;
+  tick(2500);
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    // Generate a random wrap burst which starts on a random beat of its wrap region,
+    // as a critical-word-first cache refill does
+    aw_beat = driver->rand_ax_beat();
+    aw_beat.ax_burst = BURST_WRAP;
+    // wrap bursts have 2, 4, 8 or 16 beats
+    aw_beat.ax_len = (2 << (rand() % 4)) - 1;
+    aw_beat.ax_addr += (rand() % (aw_beat.ax_len + 1)) * 8;
+    ar_beat = aw_beat;
+    uint64_t wrap_size = (aw_beat.ax_len + 1) * 8;
+    uint64_t wrap_boundary = aw_beat.ax_addr & ~(wrap_size - 1);
+    // tag bit of every capability touched by the burst
+    std::map<uint64_t, unsigned int> cap_tags;
+    driver->reset_slave();
+    driver->send_aw(aw_beat);
+    uint8_t len = aw_beat.ax_len;
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      // beats follow the wrapped address sequence
+      uint64_t addr = wrap_boundary + ((aw_beat.ax_addr - wrap_boundary + i * 8) % wrap_size);
+      uint64_t cap = addr >> (int)fabs(log2(Vtag_ctrl_testharness_tag_ctrl_testharness::CapSize / 8));
+      w_beat = driver->rand_w_beat((i == len) ? 1 : 0);
+      // both halves of a capability carry the same tag bit
+      if (cap_tags.count(cap))
+        w_beat.w_user = cap_tags[cap];
+      cap_tags[cap] = w_beat.w_user;
+      driver->send_w(w_beat);
+      axi_w_beat_q.push_back(w_beat);
+    }
+    b_beat = driver->recv_b();
+    ASSERT_EQ(b_beat.b_id, aw_beat.ax_id);
+    ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+    // read back with the same wrap burst, R beats have to come back in the same order
+    driver->send_ar(ar_beat);
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      r_beat = driver->recv_r();
+      w_beat = axi_w_beat_q.front();
+      axi_w_beat_q.pop_front();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, (i == len) ? 1 : 0);
+      ASSERT_EQ(r_beat.r_user, w_beat.w_user);
+    }
+  }
+  delete driver;
+}
+
+// FIXED bursts write the same capability on every beat, the data and tag of the last beat win.
+// A FIXED read burst returns them on every beat.
+TEST_F(CTagctrl_tb, Rand_AXI_FIXED_RW_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  axi_ax_beat_t aw_beat;
+  axi_ax_beat_t ar_beat;
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  axi_b_beat_t b_beat;
+  tick(2500);
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    aw_beat = driver->rand_ax_beat();
+    aw_beat.ax_burst = BURST_FIXED;
+    aw_beat.ax_len = 1 + rand() % 15;
+    aw_beat.ax_addr += (rand() % 512) * 8;
+    ar_beat = aw_beat;
+    driver->reset_slave();
+    driver->send_aw(aw_beat);
+    uint8_t len = aw_beat.ax_len;
+    unsigned int last_tag = rand() % 2;
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      w_beat = driver->rand_w_beat((i == len) ? 1 : 0);
+      // the beat before the last one always writes the other tag
+      if (i >= len - 1)
+        w_beat.w_user = (i == len) ? last_tag : !last_tag;
+      driver->send_w(w_beat);
+    }
+    b_beat = driver->recv_b();
+    ASSERT_EQ(b_beat.b_id, aw_beat.ax_id);
+    ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+    ar_beat.ax_len = 0;
+    driver->send_ar(ar_beat);
+    r_beat = driver->recv_r();
+    top->cpu_r_ready = 0;
+    ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+    ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+    ASSERT_EQ(r_beat.r_user, w_beat.w_user);
+    ar_beat.ax_len = len;
+    driver->send_ar(ar_beat);
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      r_beat = driver->recv_r();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, (i == len) ? 1 : 0);
+      ASSERT_EQ(r_beat.r_user, w_beat.w_user);
+    }
+  }
+  delete driver;
+}
+
+TEST_F(CTagctrl_tb, Rand_AXI_Untagged_Region_RW_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  axi_ax_beat_t aw_beat;
+  axi_ax_beat_t ar_beat;
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  axi_b_beat_t b_beat;
+  std::deque<axi_w_beat_t> axi_w_beat_q;
+  // the upper half of the DRAM range used by the random bursts holds no capabilities
+  uint64_t untagged_start = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase +
+                            (Vtag_ctrl_testharness_tag_ctrl_testharness::TagCacheMemBase -
+                             Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase) / 2;
+  uint64_t untagged_end = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCacheMemBase;
+  tick(2500);
+  driver->reset_slave();
+  driver->cfg_addr_region(0, untagged_start, untagged_end, true);
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    // bursts are 4KiB aligned and never leave their region
+    aw_beat = driver->rand_ax_beat();
+    ar_beat = aw_beat;
+    bool untagged = (aw_beat.ax_addr >= untagged_start) && (aw_beat.ax_addr < untagged_end);
+    driver->reset_slave();
+    driver->send_aw(aw_beat);
+    uint8_t len = aw_beat.ax_len;
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      w_beat = driver->rand_w_beat((i == len) ? 1 : 0);
+      // both halves of a capability carry the same tag bit
+      if (i % 2)
+        w_beat.w_user = axi_w_beat_q.back().w_user;
+      driver->send_w(w_beat);
+      axi_w_beat_q.push_back(w_beat);
+    }
+    b_beat = driver->recv_b();
+    ASSERT_EQ(b_beat.b_id, aw_beat.ax_id);
+    ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+    driver->send_ar(ar_beat);
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      r_beat = driver->recv_r();
+      w_beat = axi_w_beat_q.front();
+      axi_w_beat_q.pop_front();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, (i == len) ? 1 : 0);
+      // untagged regions never return a valid capability
+      ASSERT_EQ(r_beat.r_user, untagged ? 0 : w_beat.w_user);
+    }
+  }
+  delete driver;
+}
+
+// The register file aligns the region bounds to 4KiB. Bursts across the programmed, unaligned
+// bounds lie in a single 4KiB page and are tagged or untagged as a whole, a burst which starts
+// below the programmed end overwrites the tags of the valid capabilities behind it.
+TEST_F(CTagctrl_tb, Rand_AXI_Untagged_Region_Bound_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  axi_ax_beat_t ax_beat = {0};
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  std::deque<axi_w_beat_t> axi_w_beat_q;
+  std::map<uint64_t, uint64_t> data;
+  std::map<uint64_t, unsigned int> tag;
+  const uint64_t page = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase + 0x10000;
+  const uint32_t region_base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset;
+  // programmed bounds of the untagged region, it covers [page, page + 0x2000)
+  const uint64_t bound[2] = {page + 0x310, page + 0x2080};
+  tick(2500);
+  driver->reset_slave();
+  // the capabilities around both bounds are valid before the region is mapped
+  for (uint64_t b : bound)
+  {
+    for (uint64_t addr = b - 0x100; addr < b + 0x100; addr += 8)
+    {
+      data[addr] = rand();
+      tag[addr & ~uint64_t(15)] = 1;
+      ASSERT_EQ(driver->write_word(addr, data[addr], 1).b_resp, RESP_OKAY);
+    }
+  }
+  driver->cfg_addr_region(0, bound[0], bound[1], true);
+  ASSERT_EQ(driver->cfg_read(region_base + 0x00), (uint32_t)page);
+  ASSERT_EQ(driver->cfg_read(region_base + 0x08), (uint32_t)(page + 0x2000));
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    // a burst of whole capabilities across a programmed bound
+    uint64_t b = bound[rand() % 2];
+    ax_beat.ax_id = rand() % (1 << Vtag_ctrl_testharness_tag_ctrl_testharness::AxiIdWidth);
+    ax_beat.ax_addr = b - 16 * (1 + rand() % 8);
+    ax_beat.ax_len = 2 * (8 + rand() % 8) - 1;
+    ax_beat.ax_size = 3;
+    ax_beat.ax_burst = BURST_INCR;
+    bool untagged = (ax_beat.ax_addr >= page) && (ax_beat.ax_addr < page + 0x2000);
+    driver->reset_slave();
+    driver->send_aw(ax_beat);
+    uint8_t len = ax_beat.ax_len;
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      uint64_t addr = ax_beat.ax_addr + i * 8;
+      w_beat = driver->rand_w_beat((i == len) ? 1 : 0);
+      // both halves of a capability carry the same tag bit
+      if (i % 2)
+        w_beat.w_user = axi_w_beat_q.back().w_user;
+      data[addr] = w_beat.w_data;
+      if (!untagged)
+        tag[addr & ~uint64_t(15)] = w_beat.w_user;
+      driver->send_w(w_beat);
+      axi_w_beat_q.push_back(w_beat);
+    }
+    ASSERT_EQ(driver->recv_b().b_resp, RESP_OKAY);
+    driver->send_ar(ax_beat);
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      r_beat = driver->recv_r();
+      w_beat = axi_w_beat_q.front();
+      axi_w_beat_q.pop_front();
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, untagged ? 0 : w_beat.w_user);
+    }
+  }
+  for (auto &word : data)
+  {
+    bool untagged = (word.first >= page) && (word.first < page + 0x2000);
+    r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second);
+    ASSERT_EQ(r_beat.r_user, untagged ? 0 : tag[word.first & ~uint64_t(15)]);
+  }
+  delete driver;
+}
+
+TEST_F(CTagctrl_tb, Rand_AXI_Partition_RW_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  axi_ax_beat_t aw_beat;
+  axi_ax_beat_t ar_beat;
+  axi_w_beat_t w_beat;
+  axi_r_beat_t r_beat;
+  axi_b_beat_t b_beat;
+  std::deque<axi_w_beat_t> axi_w_beat_q;
+  uint64_t part_lookups[2] = {0, 0};
+  tick(2500);
+  driver->reset_slave();
+  // the lower half of the AXI IDs allocates in the lower half of the ways, all other IDs in the
+  // upper half
+  uint32_t num_ids = 1 << Vtag_ctrl_testharness_tag_ctrl_testharness::AxiIdWidth;
+  uint32_t set_asso = Vtag_ctrl_testharness_tag_ctrl_testharness::SetAssociativity;
+  uint64_t low_ways = (1ULL << (set_asso / 2)) - 1;
+  driver->cfg_partition(0, 0, 0, low_ways << (set_asso / 2));
+  driver->cfg_partition(1, 0, num_ids / 2 - 1, low_ways);
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    aw_beat = driver->rand_ax_beat();
+    ar_beat = aw_beat;
+    unsigned int part = (aw_beat.ax_id < num_ids / 2) ? 1 : 0;
+    driver->reset_slave();
+    driver->send_aw(aw_beat);
+    uint8_t len = aw_beat.ax_len;
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      w_beat = driver->rand_w_beat((i == len) ? 1 : 0);
+      // both halves of a capability carry the same tag bit
+      if (i % 2)
+        w_beat.w_user = axi_w_beat_q.back().w_user;
+      driver->send_w(w_beat);
+      axi_w_beat_q.push_back(w_beat);
+    }
+    b_beat = driver->recv_b();
+    ASSERT_EQ(b_beat.b_id, aw_beat.ax_id);
+    ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+    driver->send_ar(ar_beat);
+    for (uint64_t i = 0; i <= len; i++)
+    {
+      r_beat = driver->recv_r();
+      w_beat = axi_w_beat_q.front();
+      axi_w_beat_q.pop_front();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, w_beat.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, (i == len) ? 1 : 0);
+      ASSERT_EQ(r_beat.r_user, w_beat.w_user);
+    }
+    // one tag lookup for the write and one for the read
+    part_lookups[part] += 2;
+  }
+  // every tag lookup is counted once, in the partition of its requester
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    ASSERT_EQ(driver->cfg_partition_hits(p) + driver->cfg_partition_misses(p), part_lookups[p]);
+  }
+  delete driver;
+}
+
+// Both slave ports of the two port build interleave bursts on one tag cache line and on a page
+// mapped untagged. Port p owns the blocks of four capabilities with index % 2 == p and only
+// writes those, reads of either port go to the capabilities of both ports. A read of the other
+// port's capabilities may see the value before or after a write in flight, the tag and the data
+// reach the tag cache and the memory separately and are checked on their own.
+TEST_F(CTagctrl_tb, Rand_AXI_Two_Port_RW_OP)
+{
+  if (Vtag_ctrl_testharness_tag_ctrl_testharness::NumSlvPorts < 2)
+    GTEST_SKIP() << "needs the two slave port build, see make runtests-ports";
+  typedef struct
+  {
+    uint64_t data[2];
+    unsigned int tag;
+  } cap_t;
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t tagged_base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase + 32 * page;
+  const uint64_t untagged_base = tagged_base + page;
+  const uint32_t caps_per_block = 4;
+  const uint32_t num_blocks = 8;
+  const uint32_t num_caps = caps_per_block * num_blocks;
+  const uint64_t max_cycles = 1000 * MAX_NUM_REPS;
+  uint32_t num_ids = 1 << Vtag_ctrl_testharness_tag_ctrl_testharness::AxiIdWidth;
+  uint32_t set_asso = Vtag_ctrl_testharness_tag_ctrl_testharness::SetAssociativity;
+  uint64_t low_ways = (1ULL << (set_asso / 2)) - 1;
+  std::map<uint64_t, cap_t> mem;
+  // values a read in flight on the port may return, per capability
+  std::map<uint64_t, std::vector<cap_t>> seen[2];
+  std::vector<CPortAgent_tb> agents = {CPortAgent_tb(top, 0), CPortAgent_tb(top, 1)};
+  uint64_t bursts[2] = {0, 0};
+  tick(2500);
+  driver->reset_slave();
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    agents[p].step();
+  }
+  driver->cfg_addr_region(0, untagged_base, untagged_base + page, true);
+  // the lower half of the AXI IDs allocates in the lower half of the ways, on both ports
+  driver->cfg_partition(0, 0, 0, low_ways << (set_asso / 2));
+  driver->cfg_partition(1, 0, num_ids / 2 - 1, low_ways);
+  for (uint64_t base : {tagged_base, untagged_base})
+  {
+    for (uint32_t c = 0; c < num_caps; c++)
+    {
+      uint64_t cap = base + c * 16;
+      unsigned int tag = rand() % 2;
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        mem[cap].data[h] = rand();
+        ASSERT_EQ(driver->write_word(cap + h * 8, mem[cap].data[h], tag).b_resp, RESP_OKAY);
+      }
+      mem[cap].tag = (base == untagged_base) ? 0 : tag;
+    }
+  }
+  // capabilities of the burst of an agent
+  auto burst_caps = [](const axi_ax_beat_t &ax_beat) {
+    std::vector<uint64_t> caps;
+    for (uint32_t b = 0; b <= ax_beat.ax_len; b += 2)
+      caps.push_back(ax_beat.ax_addr + b * 8);
+    return caps;
+  };
+  // add the values of the write burst of `wr` to the values a read may return
+  auto add_inflight = [&](const CPortAgent_tb &wr, std::map<uint64_t, std::vector<cap_t>> &rd_seen) {
+    for (uint32_t b = 0; b < wr.w_beats.size(); b += 2)
+    {
+      uint64_t cap = wr.ax_beat.ax_addr + b * 8;
+      if (rd_seen.count(cap))
+      {
+        unsigned int tag = (cap >= untagged_base) ? 0 : wr.w_beats[b].w_user;
+        rd_seen[cap].push_back({{wr.w_beats[b].w_data, wr.w_beats[b + 1].w_data}, tag});
+      }
+    }
+  };
+  uint64_t start_cycle = main_time;
+  while ((bursts[0] < MAX_NUM_REPS) || (bursts[1] < MAX_NUM_REPS) || !agents[0].idle() ||
+         !agents[1].idle())
+  {
+    ASSERT_LT(main_time - start_cycle, max_cycles) << "two port traffic does not make progress";
+    for (unsigned int p = 0; p < 2; p++)
+    {
+      CPortAgent_tb &agent = agents[p];
+      CPortAgent_tb &other = agents[p ^ 1];
+      if (agent.idle() && (bursts[p] < MAX_NUM_REPS))
+      {
+        uint64_t base = (rand() % 4) ? tagged_base : untagged_base;
+        uint32_t num = 1 + rand() % caps_per_block;
+        axi_ax_beat_t ax_beat = {0};
+        ax_beat.ax_id = rand() % num_ids;
+        ax_beat.ax_len = 2 * num - 1;
+        ax_beat.ax_size = 3;
+        ax_beat.ax_burst = BURST_INCR;
+        std::vector<axi_w_beat_t> w_beats;
+        if (rand() % 2)
+        {
+          // write inside a block of this port
+          uint32_t block = 2 * (rand() % (num_blocks / 2)) + p;
+          uint32_t first = rand() % (caps_per_block - num + 1);
+          ax_beat.ax_addr = base + (block * caps_per_block + first) * 16;
+          for (uint32_t b = 0; b <= ax_beat.ax_len; b++)
+          {
+            axi_w_beat_t w_beat = driver->rand_w_beat(b == ax_beat.ax_len);
+            // both halves of a capability carry the same tag bit
+            if (b % 2)
+              w_beat.w_user = w_beats.back().w_user;
+            w_beats.push_back(w_beat);
+          }
+        }
+        else
+        {
+          // read anywhere in the window, across the blocks of both ports
+          ax_beat.ax_addr = base + (rand() % (num_caps - num + 1)) * 16;
+        }
+        agent.start(ax_beat, w_beats);
+        // a read may return the last written value of a capability or the one of a write of the
+        // other port in flight
+        if (!agent.write)
+        {
+          seen[p].clear();
+          for (uint64_t cap : burst_caps(ax_beat))
+            seen[p][cap].push_back(mem[cap]);
+          if (!other.idle() && other.write)
+            add_inflight(other, seen[p]);
+        }
+        else if (!other.idle() && !other.write)
+        {
+          add_inflight(agent, seen[p ^ 1]);
+        }
+      }
+      if (!agent.step())
+        continue;
+      bursts[p]++;
+      if (agent.write)
+      {
+        ASSERT_EQ(agent.b_beat.b_id, agent.ax_beat.ax_id);
+        ASSERT_EQ(agent.b_beat.b_resp, RESP_OKAY);
+        for (uint32_t b = 0; b < agent.w_beats.size(); b += 2)
+        {
+          uint64_t cap = agent.ax_beat.ax_addr + b * 8;
+          mem[cap].data[0] = agent.w_beats[b].w_data;
+          mem[cap].data[1] = agent.w_beats[b + 1].w_data;
+          mem[cap].tag = (cap >= untagged_base) ? 0 : agent.w_beats[b].w_user;
+        }
+        continue;
+      }
+      ASSERT_EQ(agent.r_beats.size(), agent.ax_beat.ax_len + 1);
+      for (uint32_t b = 0; b < agent.r_beats.size(); b += 2)
+      {
+        uint64_t cap = agent.ax_beat.ax_addr + b * 8;
+        bool data_seen = false, tag_seen = false;
+        for (uint32_t h = 0; h < 2; h++)
+        {
+          ASSERT_EQ(agent.r_beats[b + h].r_id, agent.ax_beat.ax_id);
+          ASSERT_EQ(agent.r_beats[b + h].r_resp, RESP_OKAY);
+        }
+        ASSERT_EQ(agent.r_beats[b].r_user, agent.r_beats[b + 1].r_user);
+        for (const cap_t &val : seen[p][cap])
+        {
+          data_seen |= (agent.r_beats[b].r_data == val.data[0]) &&
+                       (agent.r_beats[b + 1].r_data == val.data[1]);
+          tag_seen |= (agent.r_beats[b].r_user == val.tag);
+        }
+        ASSERT_TRUE(data_seen) << "port " << p << " read stale data at 0x" << std::hex << cap;
+        ASSERT_TRUE(tag_seen) << "port " << p << " read a stale tag at 0x" << std::hex << cap;
+      }
+    }
+    tick(1);
+  }
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    agents[p].step();
+  }
+  // with both ports idle every capability reads back its last written value
+  for (auto &cap : mem)
+  {
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      axi_r_beat_t r_beat = driver->read_word(cap.first + h * 8);
+      ASSERT_EQ(r_beat.r_data, cap.second.data[h]);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, cap.second.tag);
+    }
+  }
+  // the partitions are decoded from the AXI IDs of both ports
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    ASSERT_GT(driver->cfg_partition_hits(p) + driver->cfg_partition_misses(p), 0);
+  }
+  delete driver;
+}
+
+TEST_F(CTagctrl_tb, Rand_AXI_Outstanding_RD_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint32_t num_pages = 8;
+  const uint32_t num_words = 16;
+  const uint32_t max_outstanding = 4;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  tick(2500);
+  driver->reset_slave();
+  // a few pages share their tag cache lines between many accesses
+  for (uint32_t p = 0; p < num_pages; p++)
+  {
+    for (uint32_t w = 0; w < num_words; w += 2)
+    {
+      uint64_t addr = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase + p * page + w * 8;
+      axi_w_beat_t w_beat = driver->rand_w_beat(1);
+      // both halves of a capability carry the same tag bit
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        w_beat.w_data = rand();
+        ASSERT_EQ(driver->write_word(addr + h * 8, w_beat.w_data, w_beat.w_user).b_resp, RESP_OKAY);
+        mem[addr + h * 8] = w_beat;
+      }
+    }
+  }
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    // several reads in flight, secondary accesses to the same tag line merge with the first one
+    std::deque<axi_ax_beat_t> ar_beats;
+    uint32_t outstanding = 1 + rand() % max_outstanding;
+    for (uint32_t r = 0; r < outstanding; r++)
+    {
+      axi_ax_beat_t ar_beat = {0};
+      ar_beat.ax_id = r;
+      ar_beat.ax_addr = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase +
+                        (rand() % num_pages) * page + (rand() % num_words) * 8;
+      ar_beat.ax_size = 3;
+      ar_beat.ax_burst = BURST_INCR;
+      driver->send_ar(ar_beat);
+      ar_beats.push_back(ar_beat);
+    }
+    for (uint32_t r = 0; r < outstanding; r++)
+    {
+      axi_r_beat_t r_beat = driver->recv_r();
+      axi_ax_beat_t ar_beat = ar_beats.front();
+      ar_beats.pop_front();
+      ASSERT_EQ(r_beat.r_id, ar_beat.ax_id);
+      ASSERT_EQ(r_beat.r_data, mem[ar_beat.ax_addr].w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_last, 1);
+      ASSERT_EQ(r_beat.r_user, mem[ar_beat.ax_addr].w_user);
+    }
+    driver->reset_slave();
+  }
+  delete driver;
+}
+
+TEST_F(CTagctrl_tb, Rand_AXI_Background_Flush_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t num_pages = 16;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  tick(2500);
+  driver->reset_slave();
+  // one dirty tag line per page
+  for (uint32_t p = 0; p < num_pages; p++)
+  {
+    axi_w_beat_t w_beat = driver->rand_w_beat(1);
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      w_beat.w_data = rand();
+      ASSERT_EQ(driver->write_word(base + p * page + h * 8, w_beat.w_data, w_beat.w_user).b_resp,
+                RESP_OKAY);
+      mem[base + p * page + h * 8] = w_beat;
+    }
+  }
+  // a range flush writes back exactly the dirty lines of the range
+  uint64_t wr_start = top->mem_tag_wr_cnt;
+  driver->cfg_flush(true, base, base + num_pages * page);
+  while (driver->cfg_flush_busy())
+    tick(10);
+  ASSERT_EQ(driver->cfg_flush_lines(), num_pages);
+  ASSERT_EQ(top->mem_tag_wr_cnt - wr_start, num_pages);
+  // the lines stay valid and clean
+  driver->cfg_flush(true, base, base + num_pages * page);
+  while (driver->cfg_flush_busy())
+    tick(10);
+  ASSERT_EQ(driver->cfg_flush_lines(), 0);
+  ASSERT_EQ(top->mem_tag_wr_cnt - wr_start, num_pages);
+  // traffic continues during a full flush
+  driver->cfg_flush(false, 0, 0);
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    uint64_t addr = base + (rand() % num_pages) * page + (rand() % 2) * 8;
+    if (rand() % 2)
+    {
+      axi_w_beat_t w_beat = mem[addr];
+      w_beat.w_data = rand();
+      ASSERT_EQ(driver->write_word(addr, w_beat.w_data, w_beat.w_user).b_resp, RESP_OKAY);
+      mem[addr] = w_beat;
+    }
+    else
+    {
+      axi_r_beat_t r_beat = driver->read_word(addr);
+      ASSERT_EQ(r_beat.r_data, mem[addr].w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, mem[addr].w_user);
+    }
+  }
+  while (driver->cfg_flush_busy())
+    tick(10);
+  ASSERT_LE(driver->cfg_flush_lines(), num_pages);
+  for (auto &word : mem)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second.w_data);
+    ASSERT_EQ(r_beat.r_user, word.second.w_user);
+  }
+  delete driver;
+}
+
+// Tag cache lines are sectored. Sparse accesses to a page refill only the blocks of its tag line
+// they touch, the write back of the line is still a single burst over its dirty blocks.
+TEST_F(CTagctrl_tb, Rand_AXI_Sectored_Line_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t num_pages = 16;
+  // data covered by one block (tag word) of a tag line
+  const uint64_t block = 1024;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  tick(2500);
+  driver->reset_slave();
+  // write the second and the last block of each tag line
+  uint64_t rd_start = top->mem_tag_rd_cnt;
+  for (uint32_t p = 0; p < num_pages; p++)
+  {
+    for (uint64_t blk : {1, 3})
+    {
+      // both halves of a capability carry its tag
+      uint64_t addr = base + p * page + blk * block + (rand() % 64) * 16;
+      axi_w_beat_t w_beat = driver->rand_w_beat(1);
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        w_beat.w_data = rand();
+        ASSERT_EQ(driver->write_word(addr + h * 8, w_beat.w_data, w_beat.w_user).b_resp,
+                  RESP_OKAY);
+        mem[addr + h * 8] = w_beat;
+      }
+    }
+  }
+  // at most one single block refill per written block
+  ASSERT_GE(top->mem_tag_rd_cnt - rd_start, num_pages);
+  ASSERT_LE(top->mem_tag_rd_cnt - rd_start, 2 * num_pages);
+  // one write back burst per dirty line
+  uint64_t wr_start = top->mem_tag_wr_cnt;
+  driver->cfg_flush(true, base, base + num_pages * page);
+  while (driver->cfg_flush_busy())
+    tick(10);
+  ASSERT_EQ(driver->cfg_flush_lines(), num_pages);
+  ASSERT_EQ(top->mem_tag_wr_cnt - wr_start, num_pages);
+  // drop the lines, the written blocks come back from memory
+  driver->cfg_flush(false, 0, 0);
+  while (driver->cfg_flush_busy())
+    tick(10);
+  for (auto &word : mem)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second.w_data);
+    ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+    ASSERT_EQ(r_beat.r_user, word.second.w_user);
+  }
+  delete driver;
+}
+
+// Dirty tag lines of one set evict each other. The refill of an evicted line follows shortly after
+// its write back, it has to wait for the B response and return the written tags.
+TEST_F(CTagctrl_tb, Rand_AXI_Evict_Refill_Same_Set_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t set_asso = Vtag_ctrl_testharness_tag_ctrl_testharness::SetAssociativity;
+  // one tag line covers a page, the pages of a set are this far apart
+  const uint64_t set_stride =
+      page * (Vtag_ctrl_testharness_tag_ctrl_testharness::NumLines / set_asso);
+  const uint32_t num_pages = 2 * set_asso;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  tick(2500);
+  driver->reset_slave();
+  uint64_t wr_start = top->mem_tag_wr_cnt;
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    uint64_t addr = base + (rand() % num_pages) * set_stride + (rand() % (page / 16)) * 16;
+    if (!mem.count(addr) || (rand() % 2))
+    {
+      axi_w_beat_t w_beat = driver->rand_w_beat(1);
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        w_beat.w_data = rand();
+        ASSERT_EQ(driver->write_word(addr + h * 8, w_beat.w_data, w_beat.w_user).b_resp,
+                  RESP_OKAY);
+        mem[addr + h * 8] = w_beat;
+      }
+      continue;
+    }
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      axi_r_beat_t r_beat = driver->read_word(addr + h * 8);
+      ASSERT_EQ(r_beat.r_data, mem[addr + h * 8].w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, mem[addr + h * 8].w_user);
+    }
+  }
+  // more dirty lines than ways were written
+  ASSERT_GT(top->mem_tag_wr_cnt - wr_start, 0);
+  for (auto &word : mem)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second.w_data);
+    ASSERT_EQ(r_beat.r_user, word.second.w_user);
+  }
+  delete driver;
+}
+
+// Posted writes get their B response once buffered. Reads after them still observe the written
+// data and tags, and a store sequence completes faster than with non-posted writes.
+TEST_F(CTagctrl_tb, Rand_AXI_Posted_Write_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t page = 4096;
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t num_pages = 8;
+  const uint32_t num_stores = 64;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  uint64_t store_cycles[2];
+  tick(2500);
+  driver->reset_slave();
+  // the posted run goes first, it sees the cold tag cache
+  for (int posted = 1; posted >= 0; posted--)
+  {
+    driver->cfg_posted(posted, true);
+    // back to back stores of capabilities, both halves carry the same tag
+    uint64_t start = main_time;
+    for (uint32_t i = 0; i < num_stores; i++)
+    {
+      uint64_t addr = base + (rand() % num_pages) * page + (rand() % 256) * 16;
+      axi_w_beat_t w_beat = driver->rand_w_beat(1);
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        w_beat.w_data = rand();
+        ASSERT_EQ(driver->write_word(addr + h * 8, w_beat.w_data, w_beat.w_user).b_resp,
+                  RESP_OKAY);
+        mem[addr + h * 8] = w_beat;
+      }
+    }
+    store_cycles[posted] = main_time - start;
+    // every read observes the last write to its word
+    for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+    {
+      auto word = mem.begin();
+      std::advance(word, rand() % mem.size());
+      if (rand() % 2)
+      {
+        word->second.w_data = rand();
+        ASSERT_EQ(driver->write_word(word->first, word->second.w_data, word->second.w_user).b_resp,
+                  RESP_OKAY);
+      }
+      else
+      {
+        axi_r_beat_t r_beat = driver->read_word(word->first);
+        ASSERT_EQ(r_beat.r_data, word->second.w_data);
+        ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+        ASSERT_EQ(r_beat.r_user, word->second.w_user);
+      }
+    }
+    // no posted write failed
+    ASSERT_EQ(driver->cfg_posted_status() & 0x1, 0);
+    ASSERT_EQ(top->irq, 0);
+  }
+  std::cout << "store cycles non-posted: " << store_cycles[0] << " posted: " << store_cycles[1]
+            << std::endl;
+  ASSERT_LE(store_cycles[1], store_cycles[0]);
+  // posted writes to a failing memory word are acknowledged with OKAY, the errors are reported in
+  // the status register and raise the interrupt, every response is counted
+  const uint32_t posted_base = Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x400;
+  const uint32_t num_errs = 1 + rand() % 8;
+  uint64_t err_addr = mem.begin()->first;
+  driver->cfg_posted(true, true);
+  top->mem_err_addr = err_addr;
+  top->mem_err_en = 1;
+  for (uint32_t i = 0; i < num_errs; i++)
+    ASSERT_EQ(driver->write_word(err_addr, rand(), 0).b_resp, RESP_OKAY);
+  // a read of the failing word waits for the outstanding posted responses
+  ASSERT_EQ(driver->read_word(err_addr).r_resp, RESP_OKAY);
+  top->mem_err_en = 0;
+  ASSERT_EQ(driver->cfg_posted_status(), 0x1 | (RESP_SLVERR << 1));
+  ASSERT_EQ(driver->cfg_read(posted_base + 0x08), num_errs);
+  ASSERT_EQ(top->irq, 1);
+  // clearing the error drops the interrupt
+  driver->cfg_write(posted_base + 0x04, 0x1);
+  driver->cfg_write(posted_base + 0x08, 0x0);
+  ASSERT_EQ(driver->cfg_posted_status(), 0);
+  ASSERT_EQ(driver->cfg_read(posted_base + 0x08), 0);
+  ASSERT_EQ(top->irq, 0);
+  driver->cfg_posted(false, false);
+  delete driver;
+}
+
+// Reads inside a tag word take it from the tag word buffer of the slave port once it was fetched.
+// Writes in between update or invalidate the buffered tag words, every read still observes the
+// last written data and tag.
+TEST_F(CTagctrl_tb, Rand_AXI_Tag_Word_Buffer_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t buf_entries = Vtag_ctrl_testharness_tag_ctrl_testharness::TagBufEntries;
+  // data covered by one tag word
+  const uint64_t tag_word = 1024;
+  const uint32_t num_tag_words = 4;
+  std::map<uint64_t, axi_w_beat_t> mem;
+  tick(2500);
+  driver->reset_slave();
+  // capabilities spread over a few tag words, both halves carry the same tag
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    uint64_t addr = base + (rand() % num_tag_words) * tag_word + (rand() % 64) * 16;
+    axi_w_beat_t w_beat = driver->rand_w_beat(1);
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      w_beat.w_data = rand();
+      ASSERT_EQ(driver->write_word(addr + h * 8, w_beat.w_data, w_beat.w_user).b_resp, RESP_OKAY);
+      mem[addr + h * 8] = w_beat;
+    }
+  }
+  // read everything twice, only the first read of a tag word goes to the tag cache
+  uint64_t tagc_words = stage_active[12];
+  for (int rep = 0; rep < 2; rep++)
+  {
+    for (auto &word : mem)
+    {
+      axi_r_beat_t r_beat = driver->read_word(word.first);
+      ASSERT_EQ(r_beat.r_data, word.second.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, word.second.w_user);
+    }
+  }
+  tagc_words = stage_active[12] - tagc_words;
+  std::cout << "tag words from the tag cache: " << tagc_words << " reads: " << 2 * mem.size()
+            << std::endl;
+  if (buf_entries >= num_tag_words)
+    ASSERT_LE(tagc_words, num_tag_words);
+  // mixed reads and writes, the writes flip data and tags of buffered tag words
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    auto word = mem.begin();
+    std::advance(word, rand() % mem.size());
+    if (rand() % 2)
+    {
+      // both halves of the capability, they share its tag
+      uint64_t cap = word->first & ~uint64_t(15);
+      unsigned int user = word->second.w_user ^ 1;
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        mem[cap + h * 8].w_data = rand();
+        mem[cap + h * 8].w_user = user;
+        ASSERT_EQ(driver->write_word(cap + h * 8, mem[cap + h * 8].w_data, user).b_resp,
+                  RESP_OKAY);
+      }
+    }
+    else
+    {
+      axi_r_beat_t r_beat = driver->read_word(word->first);
+      ASSERT_EQ(r_beat.r_data, word->second.w_data);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, word->second.w_user);
+    }
+  }
+  delete driver;
+}
+
+// Atomics on capabilities between plain reads. Atomic loads return the old tag, swaps and
+// successful capability compare and swaps write the tag of their swap value, all other atomics
+// clear it. A failed compare and swap leaves data and tag untouched.
+TEST_F(CTagctrl_tb, Rand_AXI_Atomic_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t num_caps = 32;
+  // `axi_pkg::atop_t` encodings, little endian
+  const uint8_t atop_store = 0x10, atop_load = 0x20, atop_swap = 0x30, atop_cmp = 0x31;
+  const uint8_t atop_add = 0x0, atop_set = 0x3, atop_umax = 0x6;
+  std::map<uint64_t, uint64_t> data;
+  std::map<uint64_t, unsigned int> tag;
+  std::vector<axi_r_beat_t> r_beats;
+  tick(2500);
+  driver->reset_slave();
+  for (uint32_t i = 0; i < num_caps; i++)
+  {
+    uint64_t cap = base + i * 16;
+    tag[cap] = rand() % 2;
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      data[cap + h * 8] = rand();
+      ASSERT_EQ(driver->write_word(cap + h * 8, data[cap + h * 8], tag[cap]).b_resp, RESP_OKAY);
+    }
+  }
+  for (uint64_t i = 0; i < MAX_NUM_REPS; i++)
+  {
+    uint64_t cap = base + (rand() % num_caps) * 16;
+    uint64_t addr = cap + (rand() % 2) * 8;
+    axi_w_beat_t w_beat = {0};
+    w_beat.w_data = rand();
+    w_beat.w_strb = 0xff;
+    w_beat.w_last = 1;
+    switch (rand() % 5)
+    {
+    case 0:
+    {
+      // arithmetic atomic load, the result is no capability
+      uint8_t op = (rand() % 2) ? atop_add : atop_umax;
+      ASSERT_EQ(driver->atomic(addr, atop_load | op, BURST_INCR, {w_beat}, r_beats).b_resp,
+                RESP_OKAY);
+      ASSERT_EQ(r_beats.size(), 1);
+      ASSERT_EQ(r_beats[0].r_data, data[addr]);
+      ASSERT_EQ(r_beats[0].r_user, tag[cap]);
+      data[addr] = (op == atop_add) ? data[addr] + w_beat.w_data
+                                    : std::max(data[addr], (uint64_t)w_beat.w_data);
+      tag[cap] = 0;
+      break;
+    }
+    case 1:
+      // arithmetic atomic store, no R response
+      ASSERT_EQ(driver->atomic(addr, atop_store | atop_set, BURST_INCR, {w_beat}, r_beats).b_resp,
+                RESP_OKAY);
+      ASSERT_EQ(r_beats.size(), 0);
+      data[addr] |= w_beat.w_data;
+      tag[cap] = 0;
+      break;
+    case 2:
+      // swap, writes its tag like a plain store
+      w_beat.w_user = rand() % 2;
+      ASSERT_EQ(driver->atomic(addr, atop_swap, BURST_INCR, {w_beat}, r_beats).b_resp, RESP_OKAY);
+      ASSERT_EQ(r_beats.size(), 1);
+      ASSERT_EQ(r_beats[0].r_data, data[addr]);
+      ASSERT_EQ(r_beats[0].r_user, tag[cap]);
+      data[addr] = w_beat.w_data;
+      tag[cap] = w_beat.w_user;
+      break;
+    case 3:
+    {
+      // capability compare and swap, the compare value lies at the capability and the swap value
+      // in the other half of the 32 byte window, which wraps for the upper capability
+      bool match = rand() % 2;
+      unsigned int user = rand() % 2;
+      uint64_t swap[2] = {(uint64_t)rand(), (uint64_t)rand()};
+      std::vector<axi_w_beat_t> w_beats;
+      for (uint32_t b = 0; b < 4; b++)
+      {
+        w_beat.w_last = (b == 3);
+        w_beat.w_user = (b < 2) ? 0 : user;
+        w_beat.w_data = (b < 2) ? data[cap + b * 8] : swap[b - 2];
+        if (!match && b == 0)
+          w_beat.w_data ^= 1;
+        w_beats.push_back(w_beat);
+      }
+      axi_burst_t burst = (cap & 16) ? BURST_WRAP : BURST_INCR;
+      ASSERT_EQ(driver->atomic(cap, atop_cmp, burst, w_beats, r_beats).b_resp, RESP_OKAY);
+      ASSERT_EQ(r_beats.size(), 2);
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        ASSERT_EQ(r_beats[h].r_data, data[cap + h * 8]);
+        ASSERT_EQ(r_beats[h].r_user, tag[cap]);
+        if (match)
+          data[cap + h * 8] = swap[h];
+      }
+      if (match)
+        tag[cap] = user;
+      break;
+    }
+    default:
+    {
+      axi_r_beat_t r_beat = driver->read_word(addr);
+      ASSERT_EQ(r_beat.r_data, data[addr]);
+      ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+      ASSERT_EQ(r_beat.r_user, tag[cap]);
+      break;
+    }
+    }
+  }
+  for (auto &word : data)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second);
+    ASSERT_EQ(r_beat.r_user, tag[word.first & ~uint64_t(15)]);
+  }
+  delete driver;
+}
+
+// The tag cache write of a compare and swap is parked until memory returned its old data, the
+// AW channel takes the next burst meanwhile. Its tag word is written after the one of the
+// compare and swap.
+TEST_F(CTagctrl_tb, Atomic_CAS_Parked_OP)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t cap = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint64_t next = cap + 16;
+  // `axi_pkg::atop_t` encoding of AtomicCompare
+  const uint8_t atop_cmp = 0x31;
+  std::map<uint64_t, uint64_t> data;
+  std::map<uint64_t, unsigned int> tag;
+  tick(2500);
+  driver->reset_slave();
+  for (uint64_t c : {cap, next})
+  {
+    tag[c] = rand() % 2;
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      data[c + h * 8] = rand();
+      ASSERT_EQ(driver->write_word(c + h * 8, data[c + h * 8], tag[c]).b_resp, RESP_OKAY);
+    }
+  }
+  uint64_t aw_descs = stage_active[1];
+  // matching compare and swap, its W beats are withheld
+  axi_ax_beat_t aw_beat = {0};
+  aw_beat.ax_addr = cap;
+  aw_beat.ax_len = 3;
+  aw_beat.ax_size = 3;
+  aw_beat.ax_burst = BURST_INCR;
+  std::vector<axi_w_beat_t> cas_beats;
+  unsigned int cas_user = rand() % 2;
+  for (uint32_t b = 0; b < 4; b++)
+  {
+    axi_w_beat_t w_beat = {0};
+    w_beat.w_data = (b < 2) ? data[cap + b * 8] : rand();
+    w_beat.w_strb = 0xff;
+    w_beat.w_user = (b < 2) ? 0 : cas_user;
+    w_beat.w_last = (b == 3);
+    cas_beats.push_back(w_beat);
+  }
+  top->cpu_aw_atop = atop_cmp;
+  driver->send_aw(aw_beat);
+  top->cpu_aw_atop = 0;
+  // plain write of the next capability, its AW is taken while the compare and swap is parked
+  top->cpu_aw_id = 0;
+  top->cpu_aw_addr = next;
+  top->cpu_aw_len = 1;
+  top->cpu_aw_size = 3;
+  top->cpu_aw_burst = BURST_INCR;
+  top->cpu_aw_user = 0;
+  top->cpu_aw_valid = 1;
+  for (uint32_t cycles = 0; !top->cpu_aw_ready; cycles++)
+  {
+    ASSERT_LT(cycles, 200) << "the parked compare and swap stalls the AW channel";
+    tick(1);
+  }
+  tick(1);
+  top->cpu_aw_valid = 0;
+  tick(10);
+  ASSERT_EQ(stage_active[1] - aw_descs, 2);
+  for (auto w_beat : cas_beats)
+    driver->send_w(w_beat);
+  for (uint32_t h = 0; h < 2; h++)
+  {
+    axi_r_beat_t r_beat = driver->recv_r();
+    ASSERT_EQ(r_beat.r_data, data[cap + h * 8]);
+    ASSERT_EQ(r_beat.r_user, tag[cap]);
+    data[cap + h * 8] = cas_beats[2 + h].w_data;
+  }
+  top->cpu_r_ready = 0;
+  tag[cap] = cas_user;
+  ASSERT_EQ(driver->recv_b().b_resp, RESP_OKAY);
+  tag[next] = rand() % 2;
+  for (uint32_t h = 0; h < 2; h++)
+  {
+    axi_w_beat_t w_beat = {0};
+    data[next + h * 8] = rand();
+    w_beat.w_data = data[next + h * 8];
+    w_beat.w_strb = 0xff;
+    w_beat.w_user = tag[next];
+    w_beat.w_last = (h == 1);
+    driver->send_w(w_beat);
+  }
+  ASSERT_EQ(driver->recv_b().b_resp, RESP_OKAY);
+  for (auto &word : data)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second);
+    ASSERT_EQ(r_beat.r_user, tag[word.first & ~uint64_t(15)]);
+  }
+  delete driver;
+}
+
+// Atomics and plain bursts of both slave ports on the capabilities of one tag word. Every port
+// owns every other capability, the tag writes of the other port land around the tag read and
+// write of an atomic but never between them, the tags of the port stay exact.
+TEST_F(CTagctrl_tb, Rand_AXI_Two_Port_Atomic_OP)
+{
+  if (Vtag_ctrl_testharness_tag_ctrl_testharness::NumSlvPorts < 2)
+    GTEST_SKIP() << "needs the two slave port build, see make runtests-ports";
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase + 48 * 4096;
+  const uint32_t num_caps = 16;
+  const uint64_t max_cycles = 1000 * MAX_NUM_REPS;
+  // `axi_pkg::atop_t` encodings, little endian
+  const uint8_t atop_store = 0x10, atop_load = 0x20, atop_swap = 0x30, atop_cmp = 0x31;
+  const uint8_t atop_add = 0x0, atop_set = 0x3, atop_umax = 0x6;
+  uint32_t num_ids = 1 << Vtag_ctrl_testharness_tag_ctrl_testharness::AxiIdWidth;
+  std::map<uint64_t, uint64_t> data;
+  std::map<uint64_t, unsigned int> tag;
+  std::vector<CPortAgent_tb> agents = {CPortAgent_tb(top, 0), CPortAgent_tb(top, 1)};
+  uint64_t bursts[2] = {0, 0};
+  tick(2500);
+  driver->reset_slave();
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    agents[p].step();
+  }
+  for (uint32_t c = 0; c < num_caps; c++)
+  {
+    uint64_t cap = base + c * 16;
+    tag[cap] = rand() % 2;
+    for (uint32_t h = 0; h < 2; h++)
+    {
+      data[cap + h * 8] = rand();
+      ASSERT_EQ(driver->write_word(cap + h * 8, data[cap + h * 8], tag[cap]).b_resp, RESP_OKAY);
+    }
+  }
+  uint64_t start_cycle = main_time;
+  while ((bursts[0] < MAX_NUM_REPS) || (bursts[1] < MAX_NUM_REPS) || !agents[0].idle() ||
+         !agents[1].idle())
+  {
+    ASSERT_LT(main_time - start_cycle, max_cycles) << "two port atomics do not make progress";
+    for (unsigned int p = 0; p < 2; p++)
+    {
+      CPortAgent_tb &agent = agents[p];
+      if (agent.idle() && (bursts[p] < MAX_NUM_REPS))
+      {
+        // a capability of this port, no other burst of the port is in flight
+        uint64_t cap = base + (2 * (rand() % (num_caps / 2)) + p) * 16;
+        axi_ax_beat_t ax_beat = {0};
+        ax_beat.ax_id = rand() % num_ids;
+        ax_beat.ax_addr = cap + (rand() % 2) * 8;
+        ax_beat.ax_size = 3;
+        ax_beat.ax_burst = BURST_INCR;
+        axi_w_beat_t w_beat = {0};
+        w_beat.w_data = rand();
+        w_beat.w_strb = 0xff;
+        w_beat.w_last = 1;
+        std::vector<axi_w_beat_t> w_beats;
+        uint8_t atop = 0;
+        switch (rand() % 6)
+        {
+        case 0:
+          atop = atop_load | ((rand() % 2) ? atop_add : atop_umax);
+          w_beats.push_back(w_beat);
+          break;
+        case 1:
+          atop = atop_store | atop_set;
+          w_beats.push_back(w_beat);
+          break;
+        case 2:
+          atop = atop_swap;
+          w_beat.w_user = rand() % 2;
+          w_beats.push_back(w_beat);
+          break;
+        case 3:
+        {
+          // compare and swap of the capability, matching half of the time
+          bool match = rand() % 2;
+          unsigned int user = rand() % 2;
+          ax_beat.ax_addr = cap;
+          ax_beat.ax_len = 3;
+          ax_beat.ax_burst = (cap & 16) ? BURST_WRAP : BURST_INCR;
+          atop = atop_cmp;
+          for (uint32_t b = 0; b < 4; b++)
+          {
+            w_beat.w_last = (b == 3);
+            w_beat.w_user = (b < 2) ? 0 : user;
+            w_beat.w_data = (b < 2) ? data[cap + b * 8] : rand();
+            if (!match && b == 0)
+              w_beat.w_data ^= 1;
+            w_beats.push_back(w_beat);
+          }
+          break;
+        }
+        case 4:
+          // plain write of the capability
+          ax_beat.ax_addr = cap;
+          ax_beat.ax_len = 1;
+          w_beat.w_user = rand() % 2;
+          for (uint32_t h = 0; h < 2; h++)
+          {
+            w_beat.w_data = rand();
+            w_beat.w_last = (h == 1);
+            w_beats.push_back(w_beat);
+          }
+          break;
+        default:
+          // plain read of the capability
+          ax_beat.ax_addr = cap;
+          ax_beat.ax_len = 1;
+          break;
+        }
+        agent.start(ax_beat, w_beats, atop);
+      }
+      if (!agent.step())
+        continue;
+      bursts[p]++;
+      uint64_t addr = agent.ax_beat.ax_addr;
+      uint64_t cap = addr & ~uint64_t(15);
+      if (agent.write)
+      {
+        ASSERT_EQ(agent.b_beat.b_id, agent.ax_beat.ax_id);
+        ASSERT_EQ(agent.b_beat.b_resp, RESP_OKAY);
+      }
+      if (!agent.write || (agent.atop == atop_cmp))
+      {
+        // both halves of the capability with its old tag
+        ASSERT_EQ(agent.r_beats.size(), 2);
+        for (uint32_t h = 0; h < 2; h++)
+        {
+          ASSERT_EQ(agent.r_beats[h].r_resp, RESP_OKAY);
+          ASSERT_EQ(agent.r_beats[h].r_data, data[cap + h * 8]) << "port " << p;
+          ASSERT_EQ(agent.r_beats[h].r_user, tag[cap]) << "port " << p;
+        }
+      }
+      else if (agent.atop & 0x20)
+      {
+        ASSERT_EQ(agent.r_beats.size(), 1);
+        ASSERT_EQ(agent.r_beats[0].r_data, data[addr]) << "port " << p;
+        ASSERT_EQ(agent.r_beats[0].r_user, tag[cap]) << "port " << p;
+      }
+      else
+      {
+        ASSERT_EQ(agent.r_beats.size(), 0);
+      }
+      if (!agent.write)
+        continue;
+      const std::vector<axi_w_beat_t> &w = agent.w_beats;
+      switch (agent.atop)
+      {
+      case 0:
+        data[cap] = w[0].w_data;
+        data[cap + 8] = w[1].w_data;
+        tag[cap] = w[0].w_user;
+        break;
+      case atop_cmp:
+        if ((w[0].w_data == data[cap]) && (w[1].w_data == data[cap + 8]))
+        {
+          data[cap] = w[2].w_data;
+          data[cap + 8] = w[3].w_data;
+          tag[cap] = w[2].w_user;
+        }
+        break;
+      case atop_swap:
+        data[addr] = w[0].w_data;
+        tag[cap] = w[0].w_user;
+        break;
+      case atop_store | atop_set:
+        data[addr] |= w[0].w_data;
+        tag[cap] = 0;
+        break;
+      case atop_load | atop_add:
+        data[addr] += w[0].w_data;
+        tag[cap] = 0;
+        break;
+      default:
+        data[addr] = std::max(data[addr], (uint64_t)w[0].w_data);
+        tag[cap] = 0;
+        break;
+      }
+    }
+    tick(1);
+  }
+  for (unsigned int p = 0; p < 2; p++)
+  {
+    agents[p].step();
+  }
+  for (auto &word : data)
+  {
+    axi_r_beat_t r_beat = driver->read_word(word.first);
+    ASSERT_EQ(r_beat.r_data, word.second);
+    ASSERT_EQ(r_beat.r_user, tag[word.first & ~uint64_t(15)]);
+  }
+  delete driver;
+}
+
+// Runs every workload profile from the seeded generator against a shadow memory. Data and tags
+// of written words are checked on every read.
+TEST_F(CTagctrl_tb, Rand_AXI_Workload_Profiles)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const uint32_t num_bursts = MAX_NUM_REPS;
+  tick(2500);
+  driver->reset_slave();
+  for (size_t p = 0; p < workload_profiles.size(); p++)
+  {
+    CWorkloadGen_tb gen(workload_profiles[p], seed + p);
+    std::map<uint64_t, uint64_t> mem;
+    std::map<uint64_t, unsigned int> cap_tags;
+    uint64_t beats = 0;
+    driver->cfg_write(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x200, 0);
+    driver->cfg_write(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x208, 0);
+    uint64_t rd_start = top->mem_tag_rd_cnt;
+    uint64_t wr_start = top->mem_tag_wr_cnt;
+    vluint64_t t_start = main_time;
+    for (uint32_t i = 0; i < num_bursts; i++)
+    {
+      axi_ax_beat_t ax_beat = gen.next_ax_beat();
+      driver->reset_slave();
+      if (gen.next_is_write())
+      {
+        driver->send_aw(ax_beat);
+        for (uint32_t b = 0; b <= ax_beat.ax_len; b++)
+        {
+          uint64_t addr = ax_beat.ax_addr + b * 8;
+          axi_w_beat_t w_beat = gen.next_w_beat(addr, b == ax_beat.ax_len, cap_tags);
+          driver->send_w(w_beat);
+          mem[addr] = w_beat.w_data;
+        }
+        axi_b_beat_t b_beat = driver->recv_b();
+        ASSERT_EQ(b_beat.b_id, ax_beat.ax_id);
+        ASSERT_EQ(b_beat.b_resp, RESP_OKAY);
+      }
+      else
+      {
+        driver->send_ar(ax_beat);
+        for (uint32_t b = 0; b <= ax_beat.ax_len; b++)
+        {
+          uint64_t addr = ax_beat.ax_addr + b * 8;
+          axi_r_beat_t r_beat = driver->recv_r();
+          ASSERT_EQ(r_beat.r_id, ax_beat.ax_id);
+          ASSERT_EQ(r_beat.r_resp, RESP_OKAY);
+          ASSERT_EQ(r_beat.r_last, (b == ax_beat.ax_len) ? 1 : 0);
+          if (mem.count(addr))
+          {
+            ASSERT_EQ(r_beat.r_data, mem[addr]) << "profile " << gen.get_profile().name
+                                                << " seed " << seed + p;
+            ASSERT_EQ(r_beat.r_user, cap_tags[addr >> 4]) << "profile " << gen.get_profile().name
+                                                          << " seed " << seed + p;
+          }
+        }
+      }
+      beats += ax_beat.ax_len + 1;
+    }
+    uint64_t hits = driver->cfg_partition_hits(0);
+    uint64_t misses = driver->cfg_partition_misses(0);
+    std::cout << std::left << std::setw(14) << gen.get_profile().name
+              << " seed: " << seed + p << " bursts: " << num_bursts << " beats: " << beats
+              << " tag hit rate: " << std::fixed << std::setprecision(2)
+              << (hits + misses ? 100.0 * hits / (hits + misses) : 0.0) << "%"
+              << " tag reads: " << top->mem_tag_rd_cnt - rd_start
+              << " tag writes: " << top->mem_tag_wr_cnt - wr_start
+              << " cycles: " << main_time - t_start << std::endl;
+  }
+  delete driver;
+}
+
+// Compares the tag cache replacement policies, the policy is selected when verilating with
+// -GTAG_REPL_POLICY=<n>. `make bench` runs this test for all policies. Every access touches a
+// different tag cache line, one 4KiB page of data shares a tag line.
+TEST_F(CTagctrl_tb, Bench_Repl_Policy)
+{
+  CTagCtrlDriver_tb *driver = new CTagCtrlDriver_tb(top, this);
+  const char *policy_names[] = {"random", "plru", "srrip", "brrip"};
+  const uint64_t page = 4096;
+  const uint64_t base = Vtag_ctrl_testharness_tag_ctrl_testharness::DRAMMemBase;
+  const uint32_t capacity = Vtag_ctrl_testharness_tag_ctrl_testharness::SetAssociativity *
+                            Vtag_ctrl_testharness_tag_ctrl_testharness::NumLines;
+  // working sets exceed the tag cache capacity by half
+  const uint32_t num_pages = capacity + capacity / 2;
+  // fixed seed, all policies see the same access streams
+  std::mt19937_64 rng(0xC0FFEE);
+  std::map<std::string, std::vector<uint64_t>> workloads;
+  std::map<std::string, std::vector<bool>> workload_writes;
+
+  // streaming: sequential passes over all pages
+  for (int pass = 0; pass < 2; pass++)
+    for (uint32_t p = 0; p < num_pages; p++)
+      workloads["stream"].push_back(base + p * page);
+  // random: uniform accesses, a quarter of them writes
+  for (uint32_t i = 0; i < 2 * num_pages; i++)
+  {
+    workloads["random"].push_back(base + (rng() % num_pages) * page);
+    workload_writes["random"].push_back((rng() % 4) == 0);
+  }
+  // pointer chase: passes over one cyclic random permutation of the pages
+  std::vector<uint32_t> perm(num_pages);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::shuffle(perm.begin(), perm.end(), rng);
+  for (int pass = 0; pass < 3; pass++)
+    for (uint32_t p = 0; p < num_pages; p++)
+      workloads["pointer_chase"].push_back(base + perm[p] * page);
+  // scan resistance: a chased working set of half the capacity interrupted by sweeps over pages
+  // which are never touched again
+  for (int round = 0; round < 4; round++)
+  {
+    for (uint32_t p = 0; p < capacity / 2; p++)
+      workloads["chase_scan"].push_back(base + perm[p] * page);
+    for (uint32_t p = 0; p < capacity; p++)
+      workloads["chase_scan"].push_back(base + (num_pages + round * capacity + p) * page);
+  }
+
+  tick(2500);
+  driver->reset_slave();
+  std::cout << "Tag cache replacement policy: "
+            << policy_names[Vtag_ctrl_testharness_tag_ctrl_testharness::ReplPolicy & 0x3] << std::endl;
+  for (auto &workload : workloads)
+  {
+    const std::vector<bool> &writes = workload_writes[workload.first];
+    // clear the counters of the default partition
+    driver->cfg_write(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x200, 0);
+    driver->cfg_write(Vtag_ctrl_testharness_tag_ctrl_testharness::TagCtrlRegOffset + 0x208, 0);
+    uint64_t rd_start = top->mem_tag_rd_cnt;
+    uint64_t wr_start = top->mem_tag_wr_cnt;
+    vluint64_t t_start = main_time;
+    for (size_t i = 0; i < workload.second.size(); i++)
+    {
+      if (!writes.empty() && writes[i])
+        ASSERT_EQ(driver->write_word(workload.second[i], i, 0).b_resp, RESP_OKAY);
+      else
+        ASSERT_EQ(driver->read_word(workload.second[i]).r_resp, RESP_OKAY);
+    }
+    tick(100);
+    uint64_t hits = driver->cfg_partition_hits(0);
+    uint64_t misses = driver->cfg_partition_misses(0);
+    // one tag lookup per access
+    ASSERT_EQ(hits + misses, workload.second.size());
+    std::cout << std::left << std::setw(14) << workload.first
+              << " accesses: " << std::setw(6) << workload.second.size()
+              << " hit rate: " << std::fixed << std::setprecision(2) << std::setw(6)
+              << 100.0 * hits / (hits + misses) << "%"
+              << " tag reads: " << std::setw(6) << top->mem_tag_rd_cnt - rd_start
+              << " tag writes: " << std::setw(6) << top->mem_tag_wr_cnt - wr_start
+              << " cycles: " << main_time - t_start << std::endl;
+  }
+  delete driver;
+}
+
+int main(int argc, char **argv)
+{
+  std::clock_t c_start = std::clock();
+  auto t_start = std::chrono::high_resolution_clock::now();
+  int option_index = 0;
+  char *filename = nullptr;
+  seed = (uint64_t)time(0);
+#if VM_TRACE
+  while ((option_index = getopt(argc, argv, "hv:s:")) != -1)
+#else
+  while ((option_index = getopt(argc, argv, "hs:")) != -1)
+#endif
+  {
+    switch (option_index)
+    {
+    // Process long and short EMULATOR options
+    case 'h':
+      usage(argv[0]);
+      return 1;
+#if VM_TRACE
+    case 'v':
+    {
+      dumpfolder = optarg;
+      std::cout << "VCD dump folder path: " << dumpfolder << std::endl;
+      break;
+    }
+#endif
+    case 's':
+      seed = std::strtoull(optarg, nullptr, 0);
+      break;
     }
   }
+  std::cout << "Random seed: " << seed << " (reproduce with -s " << seed << ")" << std::endl;
   ::testing::InitGoogleTest(&argc, argv);
   auto ret = RUN_ALL_TESTS();
   std::clock_t c_end = std::clock();